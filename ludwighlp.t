@@ -226,6 +226,7 @@
   UK     Key Mapping         Maps a command string onto a keyboard key
   UP     Parent Process      Attaches the terminal to the parent process
   US     Subprocess          Attaches the terminal to a subprocess
+  UU     Undo                Undoes the last command; -UU redoes it
   V      Verify              Command Procedure interactive verify
   WB     Window Back         Moves the window back over the frame
   WE     Window End          Moves the window to the end of the frame
@@ -663,6 +664,7 @@
  UK     Key Mapping
  UP     Parent Process
  US     Subprocess
+ UU     Undo
  }      Right Margin
 
  See the appropriate help entry for more information.
@@ -1328,6 +1330,9 @@
           =I     Indentation tracker, <RETURN> to current indentation, not
                  margin
           =N     Newline when <RETURN> is pressed in insert mode
+          =A     Adaptive redraw, skip window updates a slow terminal
+                 can't keep up with
+          =V     Keep the frame on view in a viewport below the current frame
 
      M    left and right margin settings (default is M=(1,terminal_width))
                  The character "." represents the column containing Dot.
@@ -1337,9 +1342,6 @@
 
 
 
-
-
-
 !
 \%
      T    set and clear tabs:
@@ -2555,7 +2557,7 @@
   UK     Key Mapping         Maps a command string onto a keyboard key
   UP     Parent Process      Attaches the terminal to the parent process
   US     Subprocess          Attaches the terminal to a subprocess
-
+  UU     Undo                Undoes the last command; -UU redoes it
 
 
 
@@ -2742,6 +2744,30 @@
  LEADING PARAMETER: [none,   ,   ,    ,    ,   ,   ,   ] US
 !
 {#endif}
+\UU
+ UU      UNDO
+ ==      ====
+
+   This command undoes the changes made to the current frame by the last
+ command, and moves Dot back to where it was before that command.  nUU undoes
+ the last n commands.  -UU redoes the last command undone, and -nUU redoes the
+ last n commands undone.  Commands that change the frame after an undo discard
+ the commands that could have been redone.
+
+   Each frame keeps its own changes, within the space limit of the frame (see
+ the S option of the EP command); the oldest changes are forgotten first.  The
+ command fails if there is nothing to undo or redo.
+
+
+
+
+
+
+
+
+
+ LEADING PARAMETER: [none, + , - , +n , -n ,   ,   ,   ] UU
+!
 \V
  V       VERIFY
  =       ======
@@ -3734,9 +3760,10 @@
  parameter, either U, L or E (u, l or e) to specify upper, lower or edit case.
  The command moves the Dot to the right, or to the left with a negative
  leading parameter.  The command remains in effect until a character other
- than U, L or E is typed, or the end-of-line is reached.  No trailing
- parameter delimiters are required when the Case Change command is used in
- Command Procedures.
+ than U, L or E is typed, or the end-of-line is reached.  The @ parameter
+ changes the case of all characters between the current position and the
+ specified mark, without moving the Dot.  No trailing parameter delimiters
+ are required when the Case Change command is used in Command Procedures.
 
  EXAMPLES:
 
@@ -3745,10 +3772,9 @@
    >*L  change all characters to lower case, from the Dot to the end of line
    <*L  change all characters to lower case, from the Dot to column one
    >*E  Changes The Rest Of The Line To Edit Case (This Is Edit Case)
+  @3*U  change all characters from the Dot to mark 3 to upper case
 
-
-
- LEADING PARAMETER: [none, + , - , +n , -n , > , < ,   ] *
+ LEADING PARAMETER: [none, + , - , +n , -n , > , < , @ ] *
 !
 \{
  {       LEFT MARGIN
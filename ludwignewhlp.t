@@ -265,6 +265,7 @@
   TS     Text Swap           Swaps a pair of lines
   TX     Text Execute        Prompts for and executes a Command Procedure
   UC     Command Introducer  Types the command introducer into the text
+  UU     Undo                Undoes the last command; -UU redoes it
   V      Verify              Command Procedure interactive verify
   WB     Window Back         Moves the window back over the frame
   WC     Window Centre       Centres the window on Dot
@@ -1247,6 +1248,9 @@
           =I     Indentation tracker, <RETURN> to current indentation, not
                  margin
           =N     Newline when <RETURN> is pressed in insert mode
+          =A     Adaptive redraw, skip window updates a slow terminal
+                 can't keep up with
+          =V     Keep the frame on view in a viewport below the current frame
 
      M    left and right margin settings (default is M=(1,terminal_width))
                  The character "." represents the column containing Dot.
@@ -1256,9 +1260,6 @@
 
 
 
-
-
-
 !
 \%
      T    set and clear tabs:
@@ -2637,6 +2638,30 @@
 
  LEADING PARAMETER: [none,   ,   ,    ,    ,   ,   ,   ] OX
 !
+\UU
+ UU      UNDO
+ ==      ====
+
+   This command undoes the changes made to the current frame by the last
+ command, and moves Dot back to where it was before that command.  nUU undoes
+ the last n commands.  -UU redoes the last command undone, and -nUU redoes the
+ last n commands undone.  Commands that change the frame after an undo discard
+ the commands that could have been redone.
+
+   Each frame keeps its own changes, within the space limit of the frame (see
+ the S option of the EP command); the oldest changes are forgotten first.  The
+ command fails if there is nothing to undo or redo.
+
+
+
+
+
+
+
+
+
+ LEADING PARAMETER: [none, + , - , +n , -n ,   ,   ,   ] UU
+!
 \V
  V       VERIFY
  =       ======
@@ -3581,9 +3606,10 @@
  parameter, either U, L or E (u, l or e) to specify upper, lower or edit case.
  The command moves the Dot to the right, or to the left with a negative
  leading parameter.  The command remains in effect until a character other
- than U, L or E is typed, or the end-of-line is reached.  No trailing
- parameter delimiters are required when the Case Change command is used in
- Command Procedures.
+ than U, L or E is typed, or the end-of-line is reached.  The @ parameter
+ changes the case of all characters between the current position and the
+ specified mark, without moving the Dot.  No trailing parameter delimiters
+ are required when the Case Change command is used in Command Procedures.
 
  EXAMPLES:
 
@@ -3592,10 +3618,9 @@
    >TCL  change all characters to lower case, from the Dot to the end of line
    <TCL  change all characters to lower case, from the Dot to column one
    >TCE  Changes The Rest Of The Line To Edit Case (This Is Edit Case)
+  @3TCU  change all characters from the Dot to mark 3 to upper case
 
-
-
- LEADING PARAMETER: [none, + , - , +n , -n , > , < ,   ] TC
+ LEADING PARAMETER: [none, + , - , +n , -n , > , < , @ ] TC
 !
 \{
  {      LEFT MARGIN
@@ -25,24 +25,121 @@
 #include "caseditto.h"
 
 #include "ch.h"
+#include "line.h"
 #include "mark.h"
 #include "screen.h"
 #include "text.h"
 #include "var.h"
 #include "vdu.h"
 
+#include <algorithm>
+#include <array>
 #include <unordered_set>
 
-const std::string LETTERS_S("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz");
-const std::unordered_set<char> LETTERS(std::begin(LETTERS_S), std::end(LETTERS_S));
+namespace {
 
-char char_toupper(char ch) {
-    return std::toupper(ch);
-}
+    using case_table = std::array<char, ORD_MAXCHAR + 1>;
 
-char char_tolower(char ch) {
-    return std::tolower(ch);
-}
+    constexpr case_table make_case_table(char from, char to) {
+        case_table table{};
+        for (int ch = 0; ch <= ORD_MAXCHAR; ++ch)
+            table[ch] = static_cast<char>(ch);
+        for (int i = 0; i < 26; ++i)
+            table[from + i] = static_cast<char>(to + i);
+        return table;
+    }
+
+    constexpr case_table UPPER_CASE = make_case_table('a', 'A');
+    constexpr case_table LOWER_CASE = make_case_table('A', 'a');
+
+    bool is_letter(char ch) {
+        auto i = static_cast<unsigned char>(ch);
+        return UPPER_CASE[i] != LOWER_CASE[i];
+    }
+
+    void case_change(
+        commands command, char prev, str_object::iterator first, str_object::iterator last
+    ) {
+        /* Purpose  : Change the case of a run of characters.
+           Inputs   : command: cmd_case_up, cmd_case_low or cmd_case_edit.
+                      prev: the character before the run, for edit case.
+                      first, last: the run of characters.
+           Outputs  : The characters are changed in place.
+        */
+        auto lookup = [](const case_table &table) {
+            return [&table](char ch) { return table[static_cast<unsigned char>(ch)]; };
+        };
+        switch (command) {
+        case commands::cmd_case_up:
+            std::transform(first, last, first, lookup(UPPER_CASE));
+            break;
+        case commands::cmd_case_low:
+            std::transform(first, last, first, lookup(LOWER_CASE));
+            break;
+        case commands::cmd_case_edit:
+            for (auto i = first; i != last; ++i) {
+                const case_table &table = is_letter(prev) ? LOWER_CASE : UPPER_CASE;
+                prev = *i = table[static_cast<unsigned char>(*i)];
+            }
+            break;
+        default:
+            // Ditto leaves the text alone.
+            break;
+        }
+    }
+
+    bool case_change_region(commands command, mark_ptr the_mark) {
+        /* Purpose  : Change the case of all the text between Dot and a mark.
+           Inputs   : command: cmd_case_up, cmd_case_low or cmd_case_edit.
+                      the_mark: the other end of the region, either side of Dot.
+           Outputs  : Each line of the region is rewritten once.  Dot is not moved.
+        */
+        bool result = false;
+        mark_ptr here = nullptr;
+        const_mark_ptr first = current_frame->dot;
+        const_mark_ptr last = the_mark;
+        line_range first_nr;
+        line_range last_nr;
+        if (!line_to_number(first->line, first_nr))
+            return false;
+        if (!line_to_number(last->line, last_nr))
+            return false;
+        if ((first_nr > last_nr) || ((first_nr == last_nr) && (first->col > last->col)))
+            std::swap(first, last);
+        line_ptr line = first->line;
+        col_range first_col = first->col;
+        while (true) {
+            int last_col = line->used;
+            if ((line == last->line) && (last->col <= last_col))
+                last_col = last->col - 1;
+            int count = last_col + 1 - first_col;
+            if (count > 0) {
+                str_object new_str;
+                new_str.copy(*line->str, first_col, count);
+                char prev = ' ';
+                if (first_col > 1)
+                    prev = (*line->str)[first_col - 1];
+                case_change(command, prev, new_str.begin(), new_str.begin() + count);
+                if (!new_str.equals(*line->str, count, 1, first_col)) {
+                    if (!mark_create(line, first_col, here))
+                        goto l99;
+                    if (!text_overtype(true, 1, new_str, count, here))
+                        goto l99;
+                }
+            }
+            if (line == last->line)
+                break;
+            line = line->flink;
+            first_col = 1;
+        }
+        result = true;
+    l99:;
+        if (here != nullptr)
+            mark_destroy(here);
+        return result;
+    }
+
+} // namespace
 
 bool key_is_lower(key_code_range key) {
     if (key < 0 || key > ORD_MAXCHAR) {
@@ -53,6 +150,18 @@ bool key_is_lower(key_code_range key) {
 
 bool caseditto_command(commands command, leadparam rept, int count, bool from_span) {
     bool cmd_status = false;
+    if (rept == leadparam::marker) {
+        cmd_status = case_change_region(command, current_frame->marks[count]);
+        if (cmd_status) {
+            current_frame->text_modified = true;
+            mark_create(
+                current_frame->dot->line,
+                current_frame->dot->col,
+                current_frame->marks[MARK_MODIFIED]
+            );
+        }
+        return cmd_status;
+    }
     bool insert =
         (command == commands::cmd_ditto_up || command == commands::cmd_ditto_down) &&
         ((edit_mode == mode_type::mode_insert) ||
@@ -166,37 +275,10 @@ bool caseditto_command(commands command, leadparam rept, int count, bool from_sp
                 new_str.fill_n(' ', count);
             else
                 ch_fillcopy(other_line->str, first_col.value(), i, &new_str, 1, count, ' ');
-            switch (command) {
-            case commands::cmd_case_up:
-                new_str.apply_n(char_toupper, count);
-                break;
-            case commands::cmd_case_low:
-                new_str.apply_n(char_tolower, count);
-                break;
-            case commands::cmd_case_edit:
-                {
-                    char ch;
-                    if ((1 < first_col) && (first_col <= other_line->used))
-                        ch = (*other_line->str)[first_col - 1];
-                    else
-                        ch = ' ';
-                    for (int j = 1; j <= count; ++j) {
-                        if (LETTERS.find(ch) != LETTERS.end())
-                            ch = std::tolower(new_str[j]);
-                        else
-                            ch = std::toupper(new_str[j]);
-                        new_str[j] = ch;
-                    }
-                }
-                break;
-            case commands::cmd_ditto_up:
-            case commands::cmd_ditto_down:
-                // No massaging required.
-                break;
-            default:
-                // Others ignored.
-                break;
-            }
+            char prev = ' ';
+            if ((1 < first_col) && (first_col <= other_line->used))
+                prev = (*other_line->str)[first_col - 1];
+            case_change(command, prev, new_str.begin(), new_str.begin() + count);
             current_frame->dot->col = first_col;
             if (insert) {
                 if (!text_insert(true, 1, new_str, count, current_frame->dot))
@@ -25,9 +25,12 @@
 #include "charcmd.h"
 
 #include "ch.h"
+#include "journal.h"
+#include "line.h"
 #include "mark.h"
 #include "screen.h"
 #include "text.h"
+#include "undo.h"
 #include "var.h"
 #include "vdu.h"
 
@@ -156,8 +159,10 @@ bool charcmd_delete(commands cmd, leadparam rept, int count, bool from_span) {
             // Nothing
             break;
         }
-        if (cmd_valid) {
+        if (cmd_valid && line_unshare(current_frame->dot->line)) {
             // Update the text of the line.
+            undo_line_change(current_frame->dot->line);
+            journal_line_change(current_frame->dot->line);
             strlen_range old_used = current_frame->dot->line->used;
             int length = (current_frame->dot->line->used + 1) - (current_frame->dot->col + count);
             if (length > 0) {
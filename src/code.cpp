@@ -76,6 +76,7 @@ namespace {
         mark_object endpoint;
         int verify_count;
         bool from_span;
+        bool at_end; // Error was detected at the end of the span
     };
 
     using verify_array = std::bitset<MAX_VERIFY + 1>;
@@ -127,6 +128,7 @@ void error(parse_state &ps, const char *err_text) {
     // Inserts an error message into the span where it was detected.
 
     ps.status = MSG_SYNTAX_ERROR;
+    ps.at_end = ps.from_span && ps.key == 0;
     if (ps.from_span) {
         // If possible, backup the current point one character.
         // with currentpoint do
@@ -628,61 +630,88 @@ bool scan_command(parse_state &ps, bool full_scan) {
     return true;
 }
 
-bool code_compile(span_object &span, bool from_span) {
-    bool result = false;
-    parse_state ps;
-    ps.status.clear();
-    ps.eoln = false;
-    ps.from_span = from_span;
+namespace {
+    bool compile_span(span_object &span, bool from_span, bool partial, bool &incomplete) {
+        bool result = false;
+        parse_state ps;
+        ps.status.clear();
+        ps.eoln = false;
+        ps.from_span = from_span;
+        ps.at_end = false;
+
+        // with span do
+        if (from_span) {
+            ps.startpoint = *span.mark_one; // Make Local Copies of the
+            ps.endpoint = *span.mark_two;   // PHYSICAL marks.
+            ps.currentpoint = ps.startpoint;
+        }
+        if (span.code != nullptr)
+            code_discard(span.code);
 
-    // with span do
-    if (from_span) {
-        ps.startpoint = *span.mark_one; // Make Local Copies of the
-        ps.endpoint = *span.mark_two;   // PHYSICAL marks.
-        ps.currentpoint = ps.startpoint;
+        ps.code_base = code_top;
+        ps.pc = 0; // This will be incremented before code is written.
+        ps.verify_count = 0;
+        if (!nextnonbl(ps))
+            goto l99;
+        if (ps.key == 0) {
+            error(ps, "Span contains no commands");
+            goto l99;
+        }
+        if (from_span) {
+            do {
+                if (!scan_command(ps, true))
+                    goto l99;
+            } while (ps.key != 0);
+        } else if (!scan_command(ps, false))
+            goto l99;
+
+        if (!generate(ps, leadparam::pint, 1, commands::cmd_exit_success, nullptr, 0, nullptr))
+            goto l99;
+
+        // Fill in code header.
+        span.code = new code_header;
+        // with span do
+        // with code^ do
+        span.code->ref = 1;
+        span.code->code = ps.code_base;
+        span.code->len = ps.pc;
+        span.code->flink = code_list->flink; // Link it into chain.
+        span.code->blink = code_list;
+        code_list->flink->blink = span.code;
+        code_list->flink = span.code;
+        code_top = ps.code_base + ps.pc;
+        result = true;
+    l99:
+        if (!result) {
+            // Release anything generated before the error was found.
+            for (int pc = 1; pc <= ps.pc && ps.code_base + pc < MAX_CODE; ++pc) {
+                // with compiler_code[code_base + pc] do
+                code_object &cc(compiler_code[ps.code_base + pc]);
+                if (cc.code != nullptr)
+                    code_discard(cc.code);
+                if (cc.tpar != nullptr)
+                    tpar_clean_object(*cc.tpar);
+            }
+        }
+        incomplete = partial && ps.at_end;
+        if (!ps.status.empty() && !incomplete) {
+            exit_abort = true;
+            screen_message(ps.status);
+        }
+        return result;
     }
-    if (span.code != nullptr)
-        code_discard(span.code);
+} // namespace
 
-    ps.code_base = code_top;
-    ps.pc = 0; // This will be incremented before code is written.
-    ps.verify_count = 0;
-    if (!nextnonbl(ps))
-        goto l99;
-    if (ps.key == 0) {
-        error(ps, "Span contains no commands");
-        goto l99;
-    }
-    if (from_span) {
-        do {
-            if (!scan_command(ps, true))
-                goto l99;
-        } while (ps.key != 0);
-    } else if (!scan_command(ps, false))
-        goto l99;
-
-    if (!generate(ps, leadparam::pint, 1, commands::cmd_exit_success, nullptr, 0, nullptr))
-        goto l99;
-
-    // Fill in code header.
-    span.code = new code_header;
-    // with span do
-    // with code^ do
-    span.code->ref = 1;
-    span.code->code = ps.code_base;
-    span.code->len = ps.pc;
-    span.code->flink = code_list->flink; // Link it into chain.
-    span.code->blink = code_list;
-    code_list->flink->blink = span.code;
-    code_list->flink = span.code;
-    code_top = ps.code_base + ps.pc;
-    result = true;
-l99:
-    if (!ps.status.empty()) {
-        exit_abort = true;
-        screen_message(ps.status);
-    }
-    return result;
+bool code_compile(span_object &span, bool from_span) {
+    bool incomplete;
+    return compile_span(span, from_span, false, incomplete);
+}
+
+bool code_compile_partial(span_object &span, bool &incomplete) {
+    // Compile a span that may hold only the first part of a command, such as
+    // a chunk of a command stream.  If the span ends before the command is
+    // complete, no error is reported and incomplete is set instead.
+    return compile_span(span, true, true, incomplete);
 }
 
 bool code_interpret(leadparam rept, int count, code_ptr code_head, bool from_span) {
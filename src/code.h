@@ -6,6 +6,7 @@
 void code_discard(code_ptr &code_head);
 
 [[nodiscard]] bool code_compile(span_object &span, bool from_span);
+[[nodiscard]] bool code_compile_partial(span_object &span, bool &incomplete);
 bool code_interpret(leadparam rept, int count, code_ptr code_head, bool from_span);
 
 // Visible for testing
@@ -70,6 +70,10 @@ const int MAX_WORD_SETS_M1 = MAX_WORD_SETS - 1;
 inline constexpr std::string_view BLANK_FRAME_NAME{""};
 inline constexpr std::string_view DEFAULT_FRAME_NAME{"LUDWIG"};
 
+// Crash recovery journal, kept next to the output file.
+inline constexpr std::string_view JOURNAL_SUFFIX{".lj"};
+const int JOURNAL_SYNC_SECONDS = 2; // Longest committed changes wait to be synced.
+
 // TPar interpretations
 const char TPD_LIT = '\'';        // don't do fancy processing on this one
 const char TPD_SMART = '`';       // search target is a pattern
@@ -140,8 +144,11 @@ const int PATTERN_ALPHA_START = 32; // IE. ASCII
 inline constexpr std::string_view MSG_BLANK{""};
 inline constexpr std::string_view MSG_ABORT{"Aborted. Output Files may be CORRUPTED"};
 inline constexpr std::string_view MSG_BAD_FORMAT_IN_TAB_TABLE{"Bad Format for list of Tab stops."};
+inline constexpr std::string_view MSG_BATCH_MODE_ONLY{"Allowed in batch mode only."};
 inline constexpr std::string_view MSG_CANT_KILL_FRAME{"Can't Kill Frame."};
 inline constexpr std::string_view MSG_CANT_SPLIT_NULL_LINE{"Can't split the Null line."};
+inline constexpr std::string_view MSG_CANT_START_WORKER{"Can't start batch worker process."};
+inline constexpr std::string_view MSG_CANT_WRITE_PROFILE{"Can't write profile report."};
 inline constexpr std::string_view MSG_COMMAND_NOT_VALID{"No Command starts with this character."};
 inline constexpr std::string_view MSG_COMMAND_RECURSION_LIMIT{"Command recursion limit exceeded."};
 inline constexpr std::string_view MSG_COMMENTS_ILLEGAL{"Immediate mode comments are not allowed."};
@@ -197,6 +204,8 @@ inline constexpr std::string_view MSG_NO_SUCH_SPAN{"No such span."};
 inline constexpr std::string_view MSG_NONPRINTABLE_INTRODUCER{
     "Command Introducer is not printable"
 };
+inline constexpr std::string_view MSG_NOTHING_TO_REDO{"Nothing to redo."};
+inline constexpr std::string_view MSG_NOTHING_TO_UNDO{"Nothing to undo."};
 inline constexpr std::string_view MSG_NOT_ENOUGH_INPUT_LEFT{
     "Not enough input left to satisfy request."
 };
@@ -257,6 +266,11 @@ inline constexpr std::string_view MSG_RESERVED_TPD{"Delimiter reserved for futur
 inline constexpr std::string_view MSG_INTEGER_NOT_IN_RANGE{"Integer not in range"};
 inline constexpr std::string_view MSG_MODE_ERROR{"Illegal Mode specification -- must be O,C or I"};
 inline constexpr std::string_view MSG_WRITING_FILE{"Writing File."};
+inline constexpr std::string_view MSG_JOURNAL_DOESNT_MATCH{
+    "Journal doesn't match the file, changes only partly recovered."
+};
+inline constexpr std::string_view MSG_JOURNAL_FAILED{"Can't write journal, changes not journaled."};
+inline constexpr std::string_view MSG_JOURNAL_RECOVERED{"Unsaved changes recovered from journal."};
 inline constexpr std::string_view MSG_LOADING_FILE{"Loading File."};
 inline constexpr std::string_view MSG_SAVING_FILE{"Saving File."};
 inline constexpr std::string_view MSG_PAGING{"Paging."};
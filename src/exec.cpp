@@ -37,6 +37,7 @@
 #include "newword.h"
 #include "nextbridge.h"
 #include "opsys.h"
+#include "profile.h"
 #include "quit.h"
 #include "screen.h"
 #include "span.h"
@@ -192,6 +193,7 @@ bool execute(commands command, leadparam rept, int count, tpar_ptr tparam, bool
     mark_object old_dot; // the commands = behaviour
     str_object new_str;
 
+    profile_scope profile(command);
     cmd_success = false;
     request.nxt = nullptr;
     request.con = nullptr;
@@ -380,10 +382,8 @@ bool execute(commands command, leadparam rept, int count, tpar_ptr tparam, bool
                 goto l99;
             if (!marks_squeeze(first_line, 1, last_line->flink, 1))
                 goto l99;
-            if (!lines_extract(first_line, last_line))
-                goto l99;
             if (current_frame != frame_oops) {
-                if (!lines_inject(first_line, last_line, frame_oops->last_group->last_line))
+                if (!lines_move(first_line, last_line, frame_oops->last_group->last_line))
                     goto l99;
                 // with frame_oops^ do
                 if (!mark_create(first_line, 1, frame_oops->marks[MARK_EQUALS]))
@@ -394,7 +394,8 @@ bool execute(commands command, leadparam rept, int count, tpar_ptr tparam, bool
                 mark_create(
                     frame_oops->dot->line, frame_oops->dot->col, frame_oops->marks[MARK_MODIFIED]
                 );
-            } else if (!lines_destroy(first_line, last_line))
+            } else if (!lines_extract(first_line, last_line) ||
+                       !lines_destroy(first_line, last_line))
                 goto l99;
             current_frame->dot->col = dot_col;
             current_frame->text_modified = true;
@@ -1005,7 +1006,7 @@ bool execute(commands command, leadparam rept, int count, tpar_ptr tparam, bool
             if (ludwig_mode == ludwig_mode_type::ludwig_screen)
                 vdu_flush();
         }
-        cmd_success = file_page(current_frame, exit_abort);
+        cmd_success = file_page(current_frame, exit_abort, 0);
         // Clean up the PAGING message.
         if (!from_span)
             screen_clear_msgs(false);
@@ -1197,10 +1198,12 @@ bool execute(commands command, leadparam rept, int count, tpar_ptr tparam, bool
                         if (!code_compile(*new_span, true))
                             goto l99;
                     }
-                    if (command == commands::cmd_span_compile)
+                    if (command == commands::cmd_span_compile) {
                         cmd_success = true;
-                    else
+                    } else {
+                        profile_scope span_profile(new_name);
                         cmd_success = code_interpret(rept, count, new_span->code, true);
+                    }
                 } else {
                     screen_message(MSG_NO_SUCH_SPAN);
                 }
@@ -1355,7 +1358,7 @@ bool execute(commands command, leadparam rept, int count, tpar_ptr tparam, bool
         break;
 
     case commands::cmd_user_undo:
-        cmd_success = user_undo();
+        cmd_success = user_undo(rept, count);
         break;
 
     case commands::cmd_window_backward:
@@ -1373,7 +1376,9 @@ bool execute(commands command, leadparam rept, int count, tpar_ptr tparam, bool
         break;
 
     case commands::cmd_resize_window:
-        screen_resize();
+        // Resize events often come in bursts, so just note the change and
+        // let the next screen_fixup catch up with the final size.
+        tt_winchanged = true;
         cmd_success = true;
         break;
 
@@ -1410,6 +1415,7 @@ bool execute(commands command, leadparam rept, int count, tpar_ptr tparam, bool
         }
         if (!eq_set)
             screen_message(MSG_EQUALS_NOT_SET);
+        file_read_ahead(current_frame);
     }
 l99:;
     tpar_clean_object(request);
@@ -27,11 +27,15 @@
 #include "code.h"
 #include "exec.h"
 #include "fyle.h"
+#include "journal.h"
 #include "line.h"
 #include "mark.h"
+#include "profile.h"
 #include "quit.h"
 #include "screen.h"
+#include "sys.h"
 #include "text.h"
+#include "undo.h"
 #include "var.h"
 #include "vdu.h"
 
@@ -51,6 +55,167 @@ namespace {
         write(message, false);
         std::cout << std::endl;
     }
+
+    bool batch_edit_file(const std::string &filename, code_ptr code) {
+        // Runs in a worker process.  Attach the file to the current frame
+        // exactly as FE would, apply the commands, and wind everything out
+        // through the usual close and backup processing.
+        file_name_str fnm(filename);
+        if (!file_create_open(fnm, parse_type::parse_edit, files[0], files[1]))
+            return false;
+        if (files[0] != nullptr) {
+            current_frame->input_file = 0;
+            files_frames[0] = current_frame;
+        }
+        if (files[1] != nullptr) {
+            current_frame->output_file = 1;
+            files_frames[1] = current_frame;
+        }
+        if (!file_page(current_frame, exit_abort, file_data.window))
+            return false;
+        bool result = code_interpret(leadparam::none, 1, code, true);
+        if (!result)
+            writeln(("\aCOMMAND FAILED (" + filename + ")").c_str());
+        ludwig_aborted = false;
+        quit_close_files();
+        return result;
+    }
+
+    const int STREAM_CHUNK_LINES = 100;
+
+    key_code_range first_command_key(const_line_ptr line) {
+        // Returns the first character in the lines that is neither a blank
+        // nor part of a comment, or zero if there is no such character.
+        for (; line != nullptr; line = line->flink) {
+            for (col_range col = 1; col <= line->used; ++col) {
+                char ch = (*line->str)[col];
+                if (ch == '!')
+                    break;
+                if (ch != ' ')
+                    return ch;
+            }
+        }
+        return 0;
+    }
+
+    void append_lines(line_ptr &first, line_ptr &last, line_ptr chunk_first, line_ptr chunk_last) {
+        if (chunk_first == nullptr)
+            return;
+        if (first == nullptr) {
+            first = chunk_first;
+        } else {
+            last->flink = chunk_first;
+            chunk_first->blink = last;
+        }
+        last = chunk_last;
+    }
+
+    bool batch_stream(file_ptr cmd_file, span_object &cmd_span) {
+        // Read, compile, and execute the commands a chunk at a time, so that
+        // neither the lines nor the code for a long script are held at once.
+        // The span only ever holds lines that have not yet been executed.
+        // Commands are not run until the next chunk is seen, as it may start
+        // with an exit handler for the last of them.
+        line_ptr &first = cmd_span.mark_one->line;
+        line_ptr &last = cmd_span.mark_two->line;
+        bool compiled = false;
+        while (true) {
+            line_ptr chunk_first = nullptr;
+            line_ptr chunk_last = nullptr;
+            int count;
+            if (!cmd_file->eof &&
+                !file_read(cmd_file, STREAM_CHUNK_LINES, true, chunk_first, chunk_last, count))
+                return false;
+            if (compiled) {
+                key_code_range key = first_command_key(chunk_first);
+                if (key == 0 && !cmd_file->eof) {
+                    append_lines(first, last, chunk_first, chunk_last);
+                    continue;
+                }
+                compiled = false;
+                if (key != '[') {
+                    bool result = code_interpret(leadparam::none, 1, cmd_span.code, true);
+                    code_discard(cmd_span.code);
+                    exit_abort = false;
+                    tt_controlc = false;
+                    if (!lines_destroy(first, last))
+                        return false;
+                    if (!result) {
+                        if (chunk_first != nullptr)
+                            lines_destroy(chunk_first, chunk_last);
+                        writeln("\aCOMMAND FAILED");
+                        return false;
+                    }
+                }
+            }
+            append_lines(first, last, chunk_first, chunk_last);
+            if (first_command_key(first) == 0) {
+                // Nothing but blanks and comments so far.
+                if (first != nullptr && !lines_destroy(first, last))
+                    return false;
+                if (cmd_file->eof)
+                    return true;
+                continue;
+            }
+            cmd_span.mark_one->col = 1;
+            cmd_span.mark_two->col = last->used + 1;
+            bool incomplete;
+            if (code_compile_partial(cmd_span, incomplete)) {
+                compiled = true;
+            } else if (!incomplete) {
+                return false;
+            } else if (cmd_file->eof) {
+                // Compile again to report the error.
+                if (!code_compile(cmd_span, true))
+                    return false;
+                compiled = true;
+            }
+        }
+    }
+
+    bool batch_parallel(code_ptr code) {
+        // Apply the compiled commands to each batch file, with at most
+        // file_data.workers worker processes running at once.  Each worker
+        // is a fork of this process, so it owns a private copy of all the
+        // frames and compiled code.
+        std::cout.flush();
+        size_t running = 0;
+        size_t started = 0;
+        bool result = true;
+        bool success;
+        for (const auto &filename : file_data.batch_files) {
+            if (running == file_data.workers) {
+                if (sys_wait_worker(success) < 0)
+                    return false;
+                running -= 1;
+                result = result && success;
+            }
+            long pid = sys_fork_worker();
+            if (pid < 0) {
+                screen_message(MSG_CANT_START_WORKER);
+                result = false;
+                break;
+            }
+            if (pid == 0) {
+                profile_worker(started);
+                if (batch_edit_file(filename, code))
+                    sys_exit_success();
+                sys_exit_failure();
+            }
+            running += 1;
+            started += 1;
+        }
+        for (; running > 0; --running) {
+            if (sys_wait_worker(success) < 0)
+                return false;
+            result = result && success;
+        }
+        // A worker that died without leaving its profile is already counted
+        // as failed, so what it did is simply missing from the report.
+        for (size_t worker = 0; worker < started; ++worker)
+            profile_merge(worker);
+        return result;
+    }
 }; // namespace
 
 void execute_immed() {
@@ -74,9 +239,14 @@ void execute_immed() {
             while (true) {
             l2:;
                 cmd_success = true;
+                journal_commit();
+                undo_begin_command();
 
-                // MAKE SURE THE USER CAN SEE THE CURRENT DOT POSITION.
-                screen_fixup();
+                // MAKE SURE THE USER CAN SEE THE CURRENT DOT POSITION, UNLESS
+                // THE NEXT COMMAND HAS ALREADY BEEN TYPED.  THE SCREEN CATCHES
+                // UP ONCE THE TYPE-AHEAD HAS BEEN PROCESSED.
+                if (!screen_type_ahead())
+                    screen_fixup();
 
                 key_code_range key;
                 if (edit_mode == mode_type::mode_command) {
@@ -234,6 +404,7 @@ void execute_immed() {
 #endif
                 }
 
+                undo_begin_command(); // Text typed in above is undone on its own.
                 if (key == command_introducer) {
                     if (code_compile(cmd_span, false))
                         cmd_success = code_interpret(leadparam::none, 1, cmd_span.code, false);
@@ -304,6 +475,14 @@ void execute_immed() {
                         writeln("COMMAND: ");
                     }
 
+                    if (ludwig_mode == ludwig_mode_type::ludwig_batch && file_data.stream &&
+                        file_data.batch_files.empty()) {
+                        // Execute the commands as they are read.
+                        if (!batch_stream(cmd_file, cmd_span) && cmd_span.mark_one->line != nullptr)
+                            lines_destroy(cmd_span.mark_one->line, cmd_span.mark_two->line);
+                        break;
+                    }
+
                     // Read, compile, and execute the next lot of commands.
                     int i;
                     if (file_read(
@@ -316,6 +495,16 @@ void execute_immed() {
                         )) {
                         if (cmd_span.mark_one->line != nullptr) {
                             cmd_span.mark_two->col = cmd_span.mark_two->line->used + 1;
+                            if (!file_data.batch_files.empty()) {
+                                // Compile once, then hand the code to the workers.
+                                if (!code_compile(cmd_span, true) || !batch_parallel(cmd_span.code))
+                                    writeln("\aCOMMAND FAILED");
+                                break;
+                            }
+                            if (ludwig_mode == ludwig_mode_type::ludwig_hardcopy) {
+                                journal_commit();
+                                undo_begin_command();
+                            }
                             if (code_compile(cmd_span, true)) {
                                 if (!code_interpret(leadparam::none, 1, cmd_span.code, true)) {
                                     writeln("\aCOMMAND FAILED");
@@ -29,6 +29,8 @@
 #include "screen.h"
 #include "sys.h"
 
+#include <algorithm>
+#include <cstring>
 #include <sstream>
 
 /*----------------------------------------------------------------------------*/
@@ -49,6 +51,99 @@ namespace {
         return haystack.size() >= needle.size() && haystack.substr(0, needle.size()) == needle;
     }
 
+    // Amount of a file examined at a time when copying it to another, and
+    // the shortest run of lines worth copying in the kernel.
+    const size_t COPY_CHUNK = 1 << 20;
+    const size_t COPY_SHARED = 1 << 16;
+
+    size_t unchanged_lines(const char *data, size_t size, bool entab, bool trim, int &lines) {
+        /* Finds the run of whole lines at the start of data that filesys_read
+         * and filesys_write would pass through unaltered: short lines of
+         * printable characters that won't be entabbed, nor trimmed if trim is
+         * set.  At most lines lines are taken if lines is positive.  Returns
+         * the length of the run, and the number of lines in it in lines.
+         */
+        int max_lines = lines;
+        size_t length = 0;
+        lines = 0;
+        while (length < size && lines != max_lines) {
+            const char *line = data + length;
+            auto end = static_cast<const char *>(std::memchr(line, '\n', size - length));
+            if (end == nullptr || end - line >= MAX_STRLEN)
+                break;
+            if (!std::all_of(line, end, [](char ch) { return ch >= ' ' && ch <= '~'; }))
+                break;
+            if (trim && end != line && end[-1] == ' ')
+                break;
+            if (entab && end - line >= 8 && std::all_of(line, line + 8, [](char ch) {
+                    return ch == ' ';
+                }))
+                break;
+            length += end - line + 1;
+            lines += 1;
+        }
+        return length;
+    }
+
+    bool copy_file_lines(file_ptr i_fyle, file_ptr o_fyle, int count, bool trim) {
+        /* Copies count lines, or the rest of the file if count is negative,
+         * from i_fyle to o_fyle, with the same result as filesys_read and
+         * filesys_write, less trailing spaces if trim is set.  The input is
+         * read a chunk at a time into i_fyle's own buffer, so filesys_read
+         * converts the lines that need it and later reads carry on where
+         * this leaves off.  Runs of lines those would not alter are copied
+         * as they are, long runs in the kernel if possible, so the
+         * filesystem can share their storage with the input.
+         * Returns true if the lines asked for were all copied.
+         */
+        str_object line;
+        strlen_range line_len;
+        while (count != 0) {
+            if (i_fyle->idx >= i_fyle->len) {
+                if (i_fyle->eof)
+                    return count < 0;
+                i_fyle->buf.resize(COPY_CHUNK);
+                i_fyle->len = sys_read(i_fyle->fd, i_fyle->buf.data(), COPY_CHUNK);
+                i_fyle->idx = 0;
+                if (i_fyle->len <= 0) {
+                    i_fyle->eof = true;
+                    return count < 0;
+                }
+            }
+            const char *data = i_fyle->buf.data() + i_fyle->idx;
+            size_t size = i_fyle->len - i_fyle->idx;
+            int lines = count;
+            size_t length = unchanged_lines(data, size, o_fyle->entab, trim, lines);
+            if (length > 0) {
+                size_t copied = 0;
+                if (length >= COPY_SHARED) {
+                    long offset = sys_tell(i_fyle->fd);
+                    if (offset >= 0)
+                        copied = sys_copy_range(i_fyle->fd, offset - size, o_fyle->fd, length);
+                }
+                long left = length - copied;
+                if (left > 0 && sys_write(o_fyle->fd, data + copied, left) != left)
+                    return false;
+                i_fyle->idx += length;
+                i_fyle->l_counter += lines;
+                o_fyle->l_counter += lines;
+                if (count > 0)
+                    count -= lines;
+                continue;
+            }
+            // The next line needs converting, which filesys_read does.
+            if (!filesys_read(i_fyle, line, line_len))
+                return count < 0;
+            if (trim && line_len > 0)
+                line_len = line.length(' ', line_len);
+            if (!filesys_write(o_fyle, &line, line_len))
+                return false;
+            if (count > 0)
+                count -= 1;
+        }
+        return true;
+    }
+
     std::vector<std::string> to_argv(const std::string &cmdline) {
         std::istringstream iss(cmdline);
         std::vector<std::string> v;
@@ -372,24 +467,29 @@ bool filesys_write(file_ptr fyle, str_ptr buffer, strlen_range bufsiz) {
 
 /*----------------------------------------------------------------------------*/
 
+bool filesys_copy(file_ptr i_fyle, file_ptr o_fyle) {
+    /* Copies the rest of the input file i_fyle to the output file o_fyle, as
+     * filesys_read and filesys_write would, less trailing spaces.
+     * Returns true (1) if the whole of the input was copied.
+     */
+    return copy_file_lines(i_fyle, o_fyle, -1, true) && i_fyle->eof;
+}
+
+/*----------------------------------------------------------------------------*/
+
 bool filesys_save(file_ptr i_fyle, file_ptr o_fyle, int copy_lines) {
     /*  Implements part of the File Save command. */
     file_object fyle;
 
     bool input_eof;
     off_t input_position;
-    str_object line;
-    strlen_range line_len;
     if (i_fyle != nullptr) {
         //  remember things to be restored
         input_eof = i_fyle->eof;
         input_position = sys_tell(o_fyle->fd);
 
         // copy unread portion of input file to output file
-        do {
-            if (filesys_read(i_fyle, line, line_len))
-                filesys_write(o_fyle, &line, line_len);
-        } while (!i_fyle->eof);
+        copy_file_lines(i_fyle, o_fyle, -1, false);
 
         // close input file
         filesys_close(i_fyle, 0, true);
@@ -419,12 +519,8 @@ bool filesys_save(file_ptr i_fyle, file_ptr o_fyle, int copy_lines) {
         return false;
 
     // copy lines from the input file to the output file
-    for (int i = 0; i < copy_lines; i++) {
-        if (!filesys_read(i_fyle, line, line_len))
-            return false;
-        if (!filesys_write(o_fyle, &line, line_len))
-            return false;
-    }
+    if (!copy_file_lines(i_fyle, o_fyle, copy_lines, false))
+        return false;
 
     // reposition or close the input file
     if (i_fyle == &fyle) {
@@ -450,6 +546,7 @@ bool filesys_parse(
     static const char usage[] = "usage : ludwig [-c] [-r] [-i value] [-I] "
                                 "[-s value] [-m file] [-M] [-t] [-T] "
                                 "[-b value] [-B value] [-o] [-O] [-u] "
+                                "[-P file] [-S] [-l] [-w value] [-p value file...] "
                                 "[file [file]]";
     static const char file_usage[] = "usage : [-m file] [-t] [-T] [-b value] "
                                      "[-B value] [file [file]]";
@@ -473,6 +570,11 @@ bool filesys_parse(
     int space = file_data.space;
     bool purge = file_data.purge;
     size_t versions = file_data.versions;
+    size_t workers = 0;
+    std::string profile;
+    bool stream = false;
+    bool status_line = false;
+    size_t window = 0;
 
     bool create_flag = false;
     bool read_only_flag = false;
@@ -499,7 +601,7 @@ bool filesys_parse(
     lwoptreset = 1;
     lwoptind = 1;
     int c;
-    while ((c = lwgetopt(argv, "cri:Is:m:MtTb:B:oOu")) != -1) {
+    while ((c = lwgetopt(argv, "cri:Is:m:MtTb:B:oOup:P:Slw:")) != -1) {
         switch (c) {
         case 'c':
             if (read_only_flag)
@@ -566,6 +668,33 @@ bool filesys_parse(
         case 'u':
             usage_flag = true;
             break;
+        case 'P':
+            profile = lwoptarg;
+            break;
+        case 'S':
+            stream = true;
+            break;
+        case 'l':
+            status_line = true;
+            break;
+        case 'w':
+            try {
+                window = static_cast<size_t>(std::stoul(lwoptarg));
+                if (window == 0)
+                    errors++;
+            } catch (const std::logic_error &ex) {
+                errors++;
+            }
+            break;
+        case 'p':
+            try {
+                workers = static_cast<size_t>(std::stoul(lwoptarg));
+                if (workers == 0)
+                    errors++;
+            } catch (const std::logic_error &ex) {
+                errors++;
+            }
+            break;
         }
     }
     if (usage_flag || errors) {
@@ -581,9 +710,31 @@ bool filesys_parse(
         file_data.entab = entab;
         file_data.purge = purge;
         file_data.versions = versions;
-    } else if (create_flag || read_only_flag || !initialize.empty() || space_flag || version_flag) {
+        file_data.workers = workers;
+        file_data.profile = profile;
+        file_data.stream = stream;
+        file_data.status_line = status_line;
+        file_data.window = window;
+    } else if (create_flag || read_only_flag || !initialize.empty() || space_flag || version_flag ||
+               workers != 0 || !profile.empty() || stream || status_line || window != 0) {
         return false;
     }
+    if (workers != 0) {
+        // Parallel batch processing, each file is opened later by its own worker.
+        if (create_flag || read_only_flag || stream || lwoptind >= argc) {
+            screen_message(usage);
+            return false;
+        }
+        // The commands come from the standard input, which a terminal would
+        // take over for screen mode.
+        if (sys_istty()) {
+            screen_message(MSG_BATCH_MODE_ONLY);
+            return false;
+        }
+        file_data.batch_files.assign(std::next(std::begin(argv), lwoptind), std::end(argv));
+        input->filename.clear();
+        return true;
+    }
     std::vector<std::string> file;
     for (int files = 0; lwoptind < argc; ++files) {
         if (files >= 2) {
@@ -9,6 +9,7 @@ bool filesys_close(const_file_ptr fyle, int action, bool msgs);
 [[nodiscard]] bool filesys_read(file_ptr fyle, str_object &buffer, strlen_range &outlen);
 bool filesys_rewind(file_ptr fyle);
 bool filesys_write(file_ptr fyle, str_ptr buffer, strlen_range bufsiz);
+[[nodiscard]] bool filesys_copy(file_ptr i_fyle, file_ptr o_fyle);
 
 [[nodiscard]] bool filesys_save(file_ptr i_fyle, file_ptr o_file, int copy_lines);
 
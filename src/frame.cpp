@@ -31,6 +31,7 @@
 #include "screen.h"
 #include "span.h"
 #include "tpar.h"
+#include "undo.h"
 #include "user.h"
 #include "var.h"
 #include "vdu.h"
@@ -254,6 +255,7 @@ bool frame_kill(const std::string_view &frame_name) {
     this_frame->span->frame = nullptr;
     if (!span_destroy(this_frame->span))
         return false;
+    undo_discard(this_frame);
 
     // Step 3a. -- Destroy all internal lines.
     if (!mark_destroy(this_frame->dot))
@@ -383,6 +385,18 @@ void show_options() {
     else
         screen_write_str(0, "Off");
     screen_writeln();
+    screen_write_str(4, "Adaptive Redraw       A       ");
+    if (current_frame->options.contains(frame_options_elts::opt_adaptive_redraw))
+        screen_write_str(0, "On");
+    else
+        screen_write_str(0, "Off");
+    screen_writeln();
+    screen_write_str(4, "Keep in Viewport      V       ");
+    if (current_frame->options.contains(frame_options_elts::opt_viewport))
+        screen_write_str(0, "On");
+    else
+        screen_write_str(0, "Off");
+    screen_writeln();
     screen_writeln();
     screen_pause();
     screen_home(true); // wipe out the display
@@ -413,6 +427,19 @@ bool set_opt(char ch, bool seton, frame_options &options) {
         else
             options.erase(frame_options_elts::opt_new_line);
         break;
+    case 'A':
+        if (seton)
+            options.insert(frame_options_elts::opt_adaptive_redraw);
+        else
+            options.erase(frame_options_elts::opt_adaptive_redraw);
+        break;
+    case 'V':
+        // The screen is laid out again at the next fixup.
+        if (seton)
+            options.insert(frame_options_elts::opt_viewport);
+        else
+            options.erase(frame_options_elts::opt_viewport);
+        break;
     default:
         // No such option
         screen_message(MSG_UNKNOWN_OPTION);
@@ -883,6 +910,14 @@ void print_options(const frame_options &options) {
         display_option('N', first);
         count += 2;
     }
+    if (options.contains(frame_options_elts::opt_adaptive_redraw)) {
+        display_option('A', first);
+        count += 2;
+    }
+    if (options.contains(frame_options_elts::opt_viewport)) {
+        display_option('V', first);
+        count += 2;
+    }
     if (first) {
         const char *s = "  None    ";
         screen_write_str(0, s);
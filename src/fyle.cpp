@@ -27,10 +27,12 @@
 #include "ch.h"
 #include "exec.h"
 #include "filesys.h"
+#include "journal.h"
 #include "line.h"
 #include "mark.h"
 #include "screen.h"
 #include "tpar.h"
+#include "undo.h"
 #include "var.h"
 #include "vdu.h"
 
@@ -41,7 +43,54 @@
 
 namespace {
     const std::string BLANK_NAME("                               ");
-}
+
+    bool lines_below_dot(frame_ptr frame, line_range &count) {
+        line_range dot_nr;
+        line_range eop_nr;
+        if (!line_to_number(frame->dot->line, dot_nr))
+            return false;
+        if (!line_to_number(frame->last_group->last_line, eop_nr))
+            return false;
+        count = eop_nr - dot_nr;
+        return true;
+    }
+
+    bool page_in(frame_ptr frame, size_t ahead) {
+        // Read lines from the frame's input file onto the end of the frame
+        // until its space is nearly used, or there are ahead lines below the
+        // dot if ahead is not zero.
+        while ((frame->space_left * 10 > frame->space_limit) && !tt_controlc) {
+            size_t count = 50;
+            if (ahead != 0) {
+                line_range below;
+                if (!lines_below_dot(frame, below))
+                    return false;
+                if (static_cast<size_t>(below) > ahead)
+                    break;
+                count = std::min(count, ahead + 1 - static_cast<size_t>(below));
+            }
+            int i;
+            line_ptr first_line;
+            line_ptr last_line;
+            if (!file_read(files[frame->input_file], count, true, first_line, last_line, i))
+                return false;
+            frame->input_count += i;
+
+            // Inject the inputted lines.
+            if (first_line == nullptr)
+                break;
+            if (!lines_inject(first_line, last_line, frame->last_group->last_line))
+                return false;
+
+            // IF DOT WAS ON THE NULL LINE, SHIFT IT ONTO THE FIRST LINE
+            if (frame->dot->line->flink == nullptr) {
+                if (!mark_create(first_line, frame->dot->col, frame->dot))
+                    return false;
+            }
+        }
+        return true;
+    }
+} // namespace
 
 void file_name(file_ptr fp, size_t max_len, file_name_str &act_fnm) {
     // Return a file's name, in the specified width.
@@ -377,22 +426,12 @@ bool file_windthru(frame_ptr current, bool from_span) {
         // Only bother if we are going to keep the output
         if (current->input_file >= 0) {
             if (files[current->input_file] != nullptr) {
-                if (!files[current->input_file]->eof) {
-                    // Copy the file through until eof found.
-                    str_object buffer;
-                    strlen_range outlen;
-                    while (filesys_read(files[current->input_file], buffer, outlen)) {
-                        size_t buflen = outlen > 0 ? buffer.length(' ', outlen) : 0;
-                        if (!filesys_write(files[current->output_file], &buffer, buflen)) {
-                            // Whoops, something went wrong
-                            result = false;
-                            goto l98;
-                        }
-                    }
-                }
-
-                // Status depends on if we successfully read it all
-                result = files[current->input_file]->eof;
+                // Copy the file through until eof found.  Status depends on
+                // if we successfully copied it all.
+                if (!files[current->input_file]->eof)
+                    result = filesys_copy(files[current->input_file], files[current->output_file]);
+                else
+                    result = true;
             }
         }
     }
@@ -418,7 +457,10 @@ bool file_rewind(file_ptr &fp) {
     return true;
 }
 
-bool file_page(frame_ptr current_frame, bool &exit_abort) {
+bool file_page(frame_ptr current_frame, bool &exit_abort, size_t ahead) {
+    // Page out the lines above the dot, and read in more of the input, as
+    // much as fits or, if ahead is not zero, until there are ahead lines
+    // below the dot.
     // with current_frame^,dot^ do
     line_ptr first_line;
     line_ptr last_line;
@@ -428,6 +470,7 @@ bool file_page(frame_ptr current_frame, bool &exit_abort) {
     }
     //  PAGE OUT THE STUFF ABOVE THE DOT LINE.
     if (first_line != nullptr) {
+        journal_close(current_frame); // The frame no longer holds the whole file.
         if (current_frame->output_file >= 0 &&
             !file_write(first_line, last_line, files[current_frame->output_file])) {
             // SHOULD EXIT_ABORT, NOT JUST FAIL.
@@ -436,40 +479,48 @@ bool file_page(frame_ptr current_frame, bool &exit_abort) {
         }
         if (last_line->flink == nullptr)
             return false;
-        if (!marks_squeeze(first_line, 1, last_line->flink, 1))
-            return false;
-        if (!lines_extract(first_line, last_line))
-            return false;
-        if (!lines_destroy(first_line, last_line))
+        // The lines written out can't be put back, and the changes before
+        // refer to lines by numbers that no longer hold, so forget them.
+        undo_discard(current_frame);
+        undo_pause(true);
+        bool ok = marks_squeeze(first_line, 1, last_line->flink, 1) &&
+                  lines_extract(first_line, last_line) && lines_destroy(first_line, last_line);
+        undo_pause(false);
+        if (!ok)
             return false;
     }
     //  PAGE IN THE NEW LINES
     if (current_frame->input_file < 0)
-        goto l98;
-    while ((current_frame->space_left * 10 > current_frame->space_limit) && !tt_controlc) {
-        int i;
-        if (!file_read(files[current_frame->input_file], 50, true, first_line, last_line, i))
-            return false;
-        current_frame->input_count += i;
-
-        // Inject the inputted lines.
-        if (first_line == nullptr)
-            goto l98;
-        if (!lines_inject(first_line, last_line, current_frame->last_group->last_line))
-            return false;
-
-        // IF DOT WAS ON THE NULL LINE, SHIFT IT ONTO THE FIRST LINE
-        if (current_frame->dot->line->flink == nullptr) {
-            if (!mark_create(first_line, current_frame->dot->col, current_frame->dot))
-                return false;
-        }
-    }
-l98:;
-    if (current_frame->input_file >= 0)
-        file_fix_eop(files[current_frame->input_file]->eof, current_frame->last_group->last_line);
+        return true;
+    undo_pause(true); // Reading the file in is not a change to the text.
+    bool ok = page_in(current_frame, ahead);
+    undo_pause(false);
+    if (!ok)
+        return false;
+    file_fix_eop(files[current_frame->input_file]->eof, current_frame->last_group->last_line);
     return true;
 }
 
+void file_read_ahead(frame_ptr current) {
+    // With a read-ahead window, read more of the input once the dot comes
+    // within half a window of the last line read.
+    if (file_data.window == 0 || current->input_file < 0)
+        return;
+    file_ptr input = files[current->input_file];
+    line_range below;
+    if (input == nullptr || input->eof || !lines_below_dot(current, below))
+        return;
+    if (static_cast<size_t>(below) > file_data.window / 2)
+        return;
+    undo_pause(true);
+    page_in(current, file_data.window);
+    undo_pause(false);
+    file_fix_eop(input->eof, current->last_group->last_line);
+    // A journal can only be replayed against the file as it is on disk.
+    if (input->eof && !current->text_modified)
+        journal_open(current);
+}
+
 bool check_slot_allocation(slot_range slot, bool must_be_allocated, std::string &status) {
     if ((slot < 0) == must_be_allocated) {
         status = must_be_allocated ? MSG_NO_FILE_OPEN : MSG_FILE_ALREADY_OPEN;
@@ -506,6 +557,7 @@ bool free_file(slot_range slot, std::string &status) {
     if (files_frames[slot] != nullptr) {
         // with files_frames[slot]^ do
         if (slot == files_frames[slot]->output_file) {
+            journal_close(files_frames[slot]);
             files_frames[slot]->output_file = -1;
         } else {
             file_fix_eop(true, files_frames[slot]->last_group->last_line);
@@ -580,7 +632,7 @@ bool file_command(
                 if (ludwig_mode == ludwig_mode_type::ludwig_screen)
                     vdu_flush();
             }
-            file_page(current_frame, exit_abort);
+            file_page(current_frame, exit_abort, file_data.window);
 
             // Clean up the LOADING message.
             if (!from_span)
@@ -632,10 +684,11 @@ bool file_command(
                 if (ludwig_mode == ludwig_mode_type::ludwig_screen)
                     vdu_flush();
             }
-            file_page(current_frame, exit_abort);
+            file_page(current_frame, exit_abort, file_data.window);
             // Clean up the LOADING message.
             if (!from_span)
                 screen_clear_msgs(false);
+            journal_open(current_frame);
         }
         break;
 
@@ -652,7 +705,7 @@ bool file_command(
                 goto l99;
             current_frame->input_file = file_slot;
             files_frames[file_slot] = current_frame;
-            file_page(current_frame, exit_abort);
+            file_page(current_frame, exit_abort, 0);
             // Clean up the LOADING message.
             if (!free_file(file_slot, status))
                 goto l99;
@@ -846,7 +899,7 @@ bool file_command(
                 if (ludwig_mode == ludwig_mode_type::ludwig_screen)
                     vdu_flush();
             }
-            file_page(current_frame, exit_abort);
+            file_page(current_frame, exit_abort, file_data.window);
             // Clean up the LOADING message.
             if (!from_span)
                 screen_clear_msgs(false);
@@ -906,6 +959,9 @@ bool file_command(
             if (current_frame->input_file >= 0)
                 files[current_frame->input_file]->l_counter = current_frame->input_count;
             current_frame->text_modified = false;
+            // The journal starts again from the saved file.
+            journal_close(current_frame);
+            journal_open(current_frame);
         }
         break;
 
@@ -15,7 +15,8 @@ void file_fix_eop(bool eof, line_ptr eop_line);
 [[nodiscard]] bool file_write(line_ptr first_line, const_line_ptr last_line, file_ptr fp);
 [[nodiscard]] bool file_windthru(frame_ptr current, bool from_span);
 [[nodiscard]] bool file_rewind(file_ptr &fp);
-bool file_page(frame_ptr current_frame, bool &exit_abort);
+bool file_page(frame_ptr current_frame, bool &exit_abort, size_t ahead);
+void file_read_ahead(frame_ptr current);
 [[nodiscard]] bool file_command(
     commands command, leadparam rept, int count, const_tpar_ptr tparam, bool from_span
 );
@@ -45,9 +45,9 @@ namespace {
         std::string key;
     };
 
-    std::ifstream helpfile;
-    std::unordered_map<std::string, key_type> table;
-    key_type current_key;
+    thread_local std::ifstream helpfile;
+    thread_local std::unordered_map<std::string, key_type> table;
+    thread_local key_type current_key;
 
     bool help_openfile(const std::string_view &filename) {
         helpfile.open(filename, std::ifstream::in);
@@ -0,0 +1,333 @@
+/** @file journal.cpp
+ * Crash recovery journal, see journal.h.
+ */
+
+#include "journal.h"
+
+#include "line.h"
+#include "mark.h"
+#include "screen.h"
+#include "sys.h"
+#include "var.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+    // Numbers are in the byte order of the machine, as the journal is only
+    // read back where it was written.
+    const std::string_view JOURNAL_MAGIC{"LUDJ"};
+    const uint32_t JOURNAL_VERSION = 1;
+
+    const char REC_INSERT = 'I'; // line_nr, count: insert count empty lines before line_nr.
+    const char REC_DELETE = 'D'; // line_nr, count: delete count lines from line_nr.
+    const char REC_TEXT = 'T';   // line_nr, length, text: set the text of line_nr.
+    const char REC_COMMIT = 'C'; // The records before this one make up whole commands.
+
+    struct journal_record {
+        char tag;
+        uint32_t line_nr;
+        uint32_t count;
+        std::string_view text;
+    };
+
+    struct frame_journal {
+        std::string name;
+        int fd;
+        std::vector<char> buf;              // Records of the command, not yet written.
+        std::unordered_set<line_ptr> dirty; // Lines whose text goes out at the commit.
+        std::chrono::steady_clock::time_point synced;
+        bool unsynced;
+    };
+
+    thread_local bool replaying = false;
+    thread_local std::unordered_map<frame_ptr, frame_journal> journals;
+
+    void put_bytes(std::vector<char> &buf, const void *data, size_t size) {
+        const char *p = static_cast<const char *>(data);
+        buf.insert(buf.end(), p, p + size);
+    }
+
+    void put_u32(std::vector<char> &buf, uint32_t value) {
+        put_bytes(buf, &value, sizeof(value));
+    }
+
+    bool get_u32(const std::vector<char> &data, size_t &pos, uint32_t &value) {
+        if (data.size() - pos < sizeof(value))
+            return false;
+        std::memcpy(&value, data.data() + pos, sizeof(value));
+        pos += sizeof(value);
+        return true;
+    }
+
+    // Read the record at pos, leaving pos after it.  Fails at the end of the
+    // data, or at a record cut short by a crash while writing it.
+    bool get_record(const std::vector<char> &data, size_t &pos, journal_record &rec) {
+        if (pos >= data.size())
+            return false;
+        rec.tag = data[pos++];
+        switch (rec.tag) {
+        case REC_COMMIT:
+            return true;
+        case REC_INSERT:
+        case REC_DELETE:
+            return get_u32(data, pos, rec.line_nr) && get_u32(data, pos, rec.count);
+        case REC_TEXT:
+            if (!get_u32(data, pos, rec.line_nr) || !get_u32(data, pos, rec.count))
+                return false;
+            if (rec.count > static_cast<uint32_t>(MAX_STRLEN) || data.size() - pos < rec.count)
+                return false;
+            rec.text = std::string_view(data.data() + pos, rec.count);
+            pos += rec.count;
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    std::vector<char> journal_header(const file_status &fs) {
+        std::vector<char> header;
+        put_bytes(header, JOURNAL_MAGIC.data(), JOURNAL_MAGIC.size());
+        put_u32(header, JOURNAL_VERSION);
+        int64_t size = fs.size;
+        int64_t mtime = fs.mtime;
+        put_bytes(header, &size, sizeof(size));
+        put_bytes(header, &mtime, sizeof(mtime));
+        return header;
+    }
+
+    frame_journal *find_journal(const_line_ptr line) {
+        if (journals.empty() || replaying || line->group == nullptr)
+            return nullptr;
+        auto it = journals.find(line->group->frame);
+        return it == journals.end() ? nullptr : &it->second;
+    }
+
+    bool apply_record(frame_ptr frame, const journal_record &rec) {
+        line_ptr line;
+        if (rec.line_nr == 0 || !line_from_number(frame, rec.line_nr, line) || line == nullptr)
+            return false;
+        switch (rec.tag) {
+        case REC_INSERT: {
+            line_ptr first_line;
+            line_ptr last_line;
+            if (rec.count == 0 || !lines_create(rec.count, first_line, last_line))
+                return false;
+            if (!lines_inject(first_line, last_line, line)) {
+                lines_destroy(first_line, last_line);
+                return false;
+            }
+            return true;
+        }
+        case REC_DELETE: {
+            line_ptr last_line = line;
+            for (uint32_t i = 1; i < rec.count && last_line->flink != nullptr; ++i)
+                last_line = last_line->flink;
+            if (rec.count == 0 || last_line->flink == nullptr)
+                return false;
+            return marks_squeeze(line, 1, last_line->flink, 1) &&
+                   lines_extract(line, last_line) && lines_destroy(line, last_line);
+        }
+        case REC_TEXT: {
+            if (line->flink == nullptr)
+                return false;
+            int new_used = rec.text.size();
+            if (!line_unshare(line))
+                return false;
+            if (new_used > line->len && !line_change_length(line, new_used))
+                return false;
+            if (line->used > 0)
+                line->str->fill(' ', 1, line->used);
+            if (new_used > 0)
+                line->str->copy_n(rec.text.data(), new_used);
+            line->used = new_used;
+            if (line->scr_row_nr != 0)
+                screen_draw_line(line);
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    // Replay the whole commands of a journal left for frame by an earlier
+    // session.  Returns the length of the journal that was replayed, 0 if
+    // there is none to replay, or -1 if it could not all be replayed.
+    long recover(frame_ptr frame, const std::string &name, const std::vector<char> &header) {
+        int fd = sys_open_file(name);
+        if (fd < 0)
+            return 0;
+        std::vector<char> data;
+        char chunk[8192];
+        long n;
+        while ((n = sys_read(fd, chunk, sizeof(chunk))) > 0)
+            data.insert(data.end(), chunk, chunk + n);
+        sys_close(fd);
+        // A journal for another version of the file is of no use.
+        if (data.size() < header.size() || !std::equal(header.begin(), header.end(), data.begin()))
+            return 0;
+        size_t end = header.size();
+        size_t pos = end;
+        journal_record rec;
+        while (get_record(data, pos, rec)) {
+            if (rec.tag == REC_COMMIT)
+                end = pos;
+        }
+        if (end == header.size())
+            return 0;
+
+        bool ok = true;
+        replaying = true;
+        pos = header.size();
+        while (ok && pos < end) {
+            ok = get_record(data, pos, rec);
+            if (ok && rec.tag != REC_COMMIT)
+                ok = apply_record(frame, rec);
+        }
+        replaying = false;
+        frame->text_modified = true;
+        if (!ok) {
+            screen_message(MSG_JOURNAL_DOESNT_MATCH);
+            return -1;
+        }
+        screen_message(MSG_JOURNAL_RECOVERED);
+        return end;
+    }
+
+} // namespace
+
+void journal_open(frame_ptr frame) {
+    if (ludwig_mode == ludwig_mode_type::ludwig_batch || frame->input_file < 0 ||
+        frame->output_file < 0 || journals.contains(frame))
+        return;
+    const_file_ptr input = files[frame->input_file];
+    const_file_ptr output = files[frame->output_file];
+    // Only a frame holding the whole of its file can be rebuilt from it.
+    if (input == nullptr || output == nullptr || !input->eof || output->l_counter != 0)
+        return;
+    file_status fs = sys_file_status(input->filename);
+    if (!fs.valid)
+        return;
+
+    std::vector<char> header = journal_header(fs);
+    std::string name = output->filename + std::string(JOURNAL_SUFFIX);
+    long length = recover(frame, name, header);
+    if (length < 0)
+        return; // Leave the journal, and the frame, as they are.
+    if (length == 0)
+        sys_unlink(name);
+    int fd = sys_create_file(name);
+    bool ok = fd >= 0;
+    if (ok) {
+        if (length > 0)
+            ok = sys_truncate(fd, length); // Drop any command cut short.
+        else
+            ok = sys_write(fd, header.data(), header.size()) == static_cast<long>(header.size());
+    }
+    if (!ok) {
+        screen_message(MSG_JOURNAL_FAILED);
+        if (fd >= 0) {
+            sys_close(fd);
+            sys_unlink(name);
+        }
+        return;
+    }
+    journals.emplace(
+        frame, frame_journal{name, fd, {}, {}, std::chrono::steady_clock::now(), true}
+    );
+}
+
+void journal_close(frame_ptr frame) {
+    auto it = journals.find(frame);
+    if (it == journals.end())
+        return;
+    sys_close(it->second.fd);
+    sys_unlink(it->second.name);
+    journals.erase(it);
+}
+
+void journal_commit() {
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = journals.begin(); it != journals.end();) {
+        frame_journal &j = it->second;
+        bool ok = true;
+        if (!j.buf.empty() || !j.dirty.empty()) {
+            // The dirty lines are numbered as they are now, after all of the
+            // command's inserts and deletes.
+            for (line_ptr line : j.dirty) {
+                line_range line_nr;
+                if (!line_to_number(line, line_nr))
+                    continue;
+                j.buf.push_back(REC_TEXT);
+                put_u32(j.buf, line_nr);
+                put_u32(j.buf, line->used);
+                if (line->used > 0)
+                    put_bytes(j.buf, line->str->slice(1, line->used).data(), line->used);
+            }
+            j.dirty.clear();
+            j.buf.push_back(REC_COMMIT);
+            ok = sys_write(j.fd, j.buf.data(), j.buf.size()) == static_cast<long>(j.buf.size());
+            j.buf.clear();
+            j.unsynced = true;
+        }
+        if (ok && j.unsynced && now - j.synced >= std::chrono::seconds(JOURNAL_SYNC_SECONDS)) {
+            ok = sys_sync(j.fd);
+            j.synced = now;
+            j.unsynced = false;
+        }
+        if (ok) {
+            ++it;
+        } else {
+            screen_message(MSG_JOURNAL_FAILED);
+            sys_close(j.fd);
+            sys_unlink(j.name);
+            it = journals.erase(it);
+        }
+    }
+}
+
+void journal_line_change(line_ptr line) {
+    frame_journal *j = find_journal(line);
+    if (j != nullptr && line->flink != nullptr)
+        j->dirty.insert(line);
+}
+
+void journal_lines_inject(line_ptr first_line, line_range count, line_ptr before_line) {
+    frame_journal *j = find_journal(before_line);
+    if (j == nullptr)
+        return;
+    line_range line_nr;
+    if (!line_to_number(before_line, line_nr))
+        return;
+    j->buf.push_back(REC_INSERT);
+    put_u32(j->buf, line_nr);
+    put_u32(j->buf, count);
+    line_ptr line = first_line;
+    for (line_range i = 1; i <= count; ++i, line = line->flink)
+        j->dirty.insert(line);
+}
+
+void journal_lines_extract(line_ptr first_line, line_range count) {
+    frame_journal *j = find_journal(first_line);
+    if (j == nullptr)
+        return;
+    line_range line_nr;
+    if (!line_to_number(first_line, line_nr))
+        return;
+    j->buf.push_back(REC_DELETE);
+    put_u32(j->buf, line_nr);
+    put_u32(j->buf, count);
+    if (!j->dirty.empty()) {
+        line_ptr line = first_line;
+        for (line_range i = 1; i <= count; ++i, line = line->flink)
+            j->dirty.erase(line);
+    }
+}
@@ -0,0 +1,37 @@
+/** @file journal.h
+ * Crash recovery journal for frames editing a file.
+ *
+ * While a frame holds the whole of its input file, each command's changes
+ * to it are appended to a journal file next to its output file.  The
+ * journal is removed once the frame's files are closed normally, so one
+ * that is found when the file is next loaded was left by a session that
+ * died, and is replayed to recover the unsaved changes.
+ *
+ * The journal is binary: a header identifying the input file it applies
+ * to, then records that insert or delete lines, or set the text of a
+ * line, each command's records followed by a commit record.  Only whole
+ * commands are replayed.  Changes are written at the end of each command
+ * and synced at most every JOURNAL_SYNC_SECONDS.
+ */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "type.h"
+
+// Start journaling the frame's changes, once its input file has been
+// loaded, after replaying any journal left by an earlier session.
+void journal_open(frame_ptr frame);
+// Stop journaling the frame and remove its journal.
+void journal_close(frame_ptr frame);
+// Write the changes made since the last commit.
+void journal_commit();
+
+// The text of the line is about to be changed.
+void journal_line_change(line_ptr line);
+// count lines starting at first_line are about to be injected before before_line.
+void journal_lines_inject(line_ptr first_line, line_range count, line_ptr before_line);
+// count lines starting at first_line are about to be extracted from their frame.
+void journal_lines_extract(line_ptr first_line, line_range count);
+
+#endif // !defined(JOURNAL_H)
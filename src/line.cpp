@@ -25,7 +25,9 @@
 #include "line.h"
 
 #include "ch.h"
+#include "journal.h"
 #include "screen.h"
+#include "undo.h"
 #include "var.h"
 
 //----------------------------------------------------------------------
@@ -50,6 +52,34 @@ void line_group_pool_extend() {
     }
 }
 
+void line_str_release(line_ptr line) {
+    /*
+      Purpose  : Let go of the text of a line.  The str_object is disposed of
+                 unless other lines are still sharing it.
+      Inputs   : line: pointer to the line.
+      Outputs  : none.
+      Bugchecks: none.
+    */
+
+    if (line->str_flink == nullptr) {
+        delete line->str;
+    } else {
+        line_ptr next_line = line->str_flink;
+        line_ptr prev_line = line->str_blink;
+        if (next_line == prev_line) {
+            // Only one line is left using it.
+            next_line->str_flink = nullptr;
+            next_line->str_blink = nullptr;
+        } else {
+            next_line->str_blink = prev_line;
+            prev_line->str_flink = next_line;
+        }
+        line->str_flink = nullptr;
+        line->str_blink = nullptr;
+    }
+    line->str = nullptr;
+}
+
 bool line_eop_create(frame_ptr inframe, group_ptr &group) {
     /*
       Purpose  : Create a group containing only the EOP line.
@@ -72,6 +102,8 @@ bool line_eop_create(frame_ptr inframe, group_ptr &group) {
     new_line->offset_nr = 0;
     new_line->marks.clear();
     new_line->str = nullptr;
+    new_line->str_flink = nullptr;
+    new_line->str_blink = nullptr;
     new_line->len = 0;
     new_line->used = 0;
     new_line->scr_row_nr = 0;
@@ -144,7 +176,7 @@ bool line_eop_destroy(group_ptr &group) {
     }
 #endif
     if (eop_line->str != nullptr) {
-        delete eop_line->str;
+        line_str_release(eop_line);
         eop_line->marks.clear();
 #ifdef DEBUG
         eop_line->str = nullptr;
@@ -182,6 +214,8 @@ bool lines_create(line_range line_count, line_ptr &first_line, line_ptr &last_li
         this_line->offset_nr = 0;
         this_line->marks.clear();
         this_line->str = nullptr;
+        this_line->str_flink = nullptr;
+        this_line->str_blink = nullptr;
         this_line->len = 0;
         this_line->used = 0;
         this_line->scr_row_nr = 0;
@@ -247,7 +281,7 @@ bool lines_destroy(line_ptr &first_line, line_ptr &last_line) {
         }
 #endif
         if (this_line->str != nullptr) {
-            delete this_line->str;
+            line_str_release(this_line);
             this_line->marks.clear();
 #ifdef DEBUG
             this_line->str = nullptr;
@@ -397,6 +431,8 @@ bool lines_inject(line_ptr first_line, line_ptr last_line, line_ptr before_line)
         return false;
     }
 #endif
+    undo_lines_inject(nr_new_lines, before_line);
+    journal_lines_inject(first_line, nr_new_lines, before_line);
 
     /* Define some useful pointers
      *                       +-------------+   +-------------+
@@ -554,6 +590,40 @@ bool lines_inject(line_ptr first_line, line_ptr last_line, line_ptr before_line)
     return true;
 }
 
+void lines_extract_screen(line_ptr first_line, line_range first_line_nr, line_ptr last_line) {
+    /*
+      Purpose  : Remove from the screen any of the lines about to be
+                 extracted from the screen frame.
+      Inputs   : first_line, last_line: pointers to the lines to be extracted.
+                 first_line_nr: the line number of first_line.
+      Outputs  : none.
+      Bugchecks: none.
+    */
+
+    line_ptr first_scr_line;
+    if (first_line->scr_row_nr != 0)
+        first_scr_line = first_line;
+    else {
+        // with scr_top_line^ do
+        if (first_line_nr < scr_top_line->group->first_line_nr + scr_top_line->offset_nr)
+            first_scr_line = scr_top_line;
+        else
+            return;
+    }
+    line_ptr last_scr_line;
+    if (last_line->scr_row_nr != 0)
+        last_scr_line = last_line;
+    else {
+        // with scr_bot_line^ do
+        if (last_line->group->first_line_nr + last_line->offset_nr >
+            scr_bot_line->group->first_line_nr + scr_bot_line->offset_nr)
+            last_scr_line = scr_bot_line;
+        else
+            return;
+    }
+    screen_lines_extract(first_scr_line, last_scr_line);
+}
+
 bool lines_extract(line_ptr first_line, line_ptr last_line) {
     /*
        Purpose  : Extract lines from the data structure.
@@ -621,6 +691,8 @@ bool lines_extract(line_ptr first_line, line_ptr last_line) {
     line_offset_range first_line_offset_nr = first_line->offset_nr;
     line_range first_line_nr = first_group->first_line_nr + first_line_offset_nr;
     int nr_lines_to_remove = last_group->first_line_nr + last_line->offset_nr - first_line_nr + 1;
+    undo_lines_extract(first_line, nr_lines_to_remove);
+    journal_lines_extract(first_line, nr_lines_to_remove);
 #ifdef DEBUG
     {
         // Check that there are no marks on the lines to be removed.
@@ -641,31 +713,8 @@ bool lines_extract(line_ptr first_line, line_ptr last_line) {
     }
 #endif
 
-    if (this_frame == scr_frame) {
-        line_ptr first_scr_line;
-        if (first_line->scr_row_nr != 0)
-            first_scr_line = first_line;
-        else {
-            // with scr_top_line^ do
-            if (first_line_nr < scr_top_line->group->first_line_nr + scr_top_line->offset_nr)
-                first_scr_line = scr_top_line;
-            else
-                goto done1;
-        }
-        line_ptr last_scr_line;
-        if (last_line->scr_row_nr != 0)
-            last_scr_line = last_line;
-        else {
-            // with scr_bot_line^ do
-            if (last_line->group->first_line_nr + last_line->offset_nr >
-                scr_bot_line->group->first_line_nr + scr_bot_line->offset_nr)
-                last_scr_line = scr_bot_line;
-            else
-                goto done1;
-        }
-        screen_lines_extract(first_scr_line, last_scr_line);
-    done1:;
-    }
+    if (this_frame == scr_frame)
+        lines_extract_screen(first_line, first_line_nr, last_line);
 
     // Unlink the lines.
     if (top_line != nullptr)
@@ -770,6 +819,183 @@ bool lines_extract(line_ptr first_line, line_ptr last_line) {
     return true;
 }
 
+bool lines_move(line_ptr first_line, line_ptr last_line, line_ptr before_line) {
+    /*
+      Purpose  : Move lines to before another line, which may be in another
+                 frame.  The groups lying wholly within the lines are relinked
+                 as they are, so only the lines of the groups at either end
+                 are extracted and injected one by one.
+      Inputs   : first_line, last_line: pointers to the lines to be moved.
+                 before_line: pointer to the line before which the lines are
+                 to be moved.
+      Outputs  : none.
+      Bugchecks: .first_line, last_line or before_line is nil
+                 .last_line is eop line
+                 .line has marks
+    */
+
+#ifdef DEBUG
+    if ((first_line == nullptr) || (last_line == nullptr) || (before_line == nullptr)) {
+        screen_message(DBG_LINE_PTR_IS_NIL);
+        return false;
+    }
+    if (last_line->flink == nullptr) {
+        screen_message(DBG_LINE_IS_EOP);
+        return false;
+    }
+#endif
+
+    // Find the groups lying wholly within the lines.
+    group_ptr first_group = first_line->group;
+    if (first_line->offset_nr != 0)
+        first_group = first_group->flink;
+    group_ptr last_group = last_line->group;
+    if (last_line != last_group->last_line)
+        last_group = last_group->blink;
+    if ((first_group == nullptr) || (last_group == nullptr) ||
+        (first_group->first_line_nr > last_group->first_line_nr)) {
+        if (!lines_extract(first_line, last_line))
+            return false;
+        return lines_inject(first_line, last_line, before_line);
+    }
+
+    // Take out the lines before and after the whole groups.
+    line_ptr head_last = nullptr;
+    if (first_line != first_group->first_line) {
+        head_last = first_group->first_line->blink;
+        if (!lines_extract(first_line, head_last))
+            return false;
+    }
+    line_ptr tail_first = nullptr;
+    if (last_line != last_group->last_line) {
+        tail_first = last_group->last_line->flink;
+        if (!lines_extract(tail_first, last_line))
+            return false;
+    }
+
+    // Unlink the whole groups from their frame.
+    line_ptr group_first_line = first_group->first_line;
+    line_ptr group_last_line = last_group->last_line;
+    frame_ptr this_frame = first_group->frame;
+    line_range first_line_nr = first_group->first_line_nr;
+    line_range nr_lines = last_group->first_line_nr + last_group->nr_lines - first_line_nr;
+    undo_lines_extract(group_first_line, nr_lines);
+    journal_lines_extract(group_first_line, nr_lines);
+#ifdef DEBUG
+    for (const_line_ptr this_line = group_first_line; this_line != group_last_line->flink;
+         this_line = this_line->flink) {
+        if (!this_line->marks.empty()) {
+            screen_message(DBG_LINE_HAS_MARKS);
+            return false;
+        }
+    }
+#endif
+    if (this_frame == scr_frame)
+        lines_extract_screen(group_first_line, first_line_nr, group_last_line);
+
+    line_ptr top_line = group_first_line->blink; // can be nil
+    line_ptr end_line = group_last_line->flink;
+    if (top_line != nullptr)
+        top_line->flink = end_line;
+    end_line->blink = top_line;
+    group_first_line->blink = nullptr;
+    group_last_line->flink = nullptr;
+    group_ptr top_group = first_group->blink; // can be nil
+    group_ptr end_group = last_group->flink;
+    if (top_group != nullptr)
+        top_group->flink = end_group;
+    else
+        this_frame->first_group = end_group;
+    end_group->blink = top_group;
+    first_group->blink = nullptr;
+    last_group->flink = nullptr;
+    for (group_ptr this_group = end_group; this_group != nullptr; this_group = this_group->flink)
+        this_group->first_line_nr -= nr_lines;
+
+    // Only a move between frames changes the space they use.
+    frame_ptr dest_frame = before_line->group->frame;
+    if (dest_frame != this_frame) {
+        space_range space = 0;
+        for (const_line_ptr this_line = group_first_line; this_line != nullptr;
+             this_line = this_line->flink)
+            space += this_line->len;
+        this_frame->space_left += space;
+        dest_frame->space_left -= space;
+    }
+
+    // Split the group holding before_line, so that the groups can go in
+    // ahead of it.
+    end_group = before_line->group;
+    if (before_line->offset_nr != 0) {
+        if (free_group_pool == nullptr)
+            line_group_pool_extend();
+        top_group = free_group_pool;
+        free_group_pool = top_group->flink;
+        top_group->flink = end_group;
+        top_group->blink = end_group->blink;
+        if (top_group->blink != nullptr)
+            top_group->blink->flink = top_group;
+        else
+            dest_frame->first_group = top_group;
+        end_group->blink = top_group;
+        top_group->frame = dest_frame;
+        top_group->first_line = end_group->first_line;
+        top_group->last_line = before_line->blink;
+        top_group->first_line_nr = end_group->first_line_nr;
+        top_group->nr_lines = before_line->offset_nr;
+        for (line_ptr this_line = top_group->first_line; this_line != before_line;
+             this_line = this_line->flink)
+            this_line->group = top_group;
+        end_group->first_line = before_line;
+        end_group->first_line_nr += top_group->nr_lines;
+        end_group->nr_lines -= top_group->nr_lines;
+        group_line_range offset = 0;
+        for (line_ptr this_line = before_line; this_line != end_group->last_line->flink;
+             this_line = this_line->flink) {
+            this_line->offset_nr = offset;
+            offset += 1;
+        }
+    }
+
+    // Link the groups and their lines in ahead of before_line.
+    undo_lines_inject(nr_lines, before_line);
+    journal_lines_inject(group_first_line, nr_lines, before_line);
+    top_group = end_group->blink; // can be nil
+    if (top_group != nullptr)
+        top_group->flink = first_group;
+    else
+        dest_frame->first_group = first_group;
+    first_group->blink = top_group;
+    last_group->flink = end_group;
+    end_group->blink = last_group;
+    top_line = before_line->blink; // can be nil
+    if (top_line != nullptr)
+        top_line->flink = group_first_line;
+    group_first_line->blink = top_line;
+    group_last_line->flink = before_line;
+    before_line->blink = group_last_line;
+    line_range line_nr = end_group->first_line_nr;
+    for (group_ptr this_group = first_group; this_group != end_group;
+         this_group = this_group->flink) {
+        this_group->frame = dest_frame;
+        this_group->first_line_nr = line_nr;
+        line_nr += this_group->nr_lines;
+    }
+    for (group_ptr this_group = end_group; this_group != nullptr; this_group = this_group->flink)
+        this_group->first_line_nr += nr_lines;
+
+    // Update the screen.
+    if ((before_line->scr_row_nr != 0) && (before_line != scr_top_line))
+        screen_lines_inject(group_first_line, nr_lines, before_line);
+
+    // Put back the lines before and after the whole groups.
+    if ((head_last != nullptr) && !lines_inject(first_line, head_last, group_first_line))
+        return false;
+    if ((tail_first != nullptr) && !lines_inject(tail_first, last_line, before_line))
+        return false;
+    return true;
+}
+
 bool line_change_length(line_ptr line, strlen_range new_length) {
     /*
       Purpose  : Change the length of the allocated text of a line.
@@ -804,9 +1030,9 @@ bool line_change_length(line_ptr line, strlen_range new_length) {
     } else {
         new_str = nullptr;
     }
-    // Dispose the old str_object.
+    // Dispose the old str_object, or stop sharing it.
     if (line->str != nullptr)
-        delete line->str;
+        line_str_release(line);
     // Update the amount of free space available in the frame.
     if (line->group != nullptr)
         line->group->frame->space_left += line->len - new_length;
@@ -818,6 +1044,76 @@ bool line_change_length(line_ptr line, strlen_range new_length) {
     return true;
 }
 
+bool line_share(line_ptr line, line_ptr src_line) {
+    /*
+      Purpose  : Give a line the same text as another line, by sharing the
+                 other line's str_object rather than copying it.  The text is
+                 copied by line_unshare when either line is about to change.
+      Inputs   : line: pointer to the line, which must not have any text.
+                 src_line: pointer to the line whose text is to be shared.
+      Outputs  : none.
+      Bugchecks: .line or src_line is nil
+                 .line already has text
+    */
+
+#ifdef DEBUG
+    if ((line == nullptr) || (src_line == nullptr)) {
+        screen_message(DBG_LINE_PTR_IS_NIL);
+        return false;
+    }
+    if (line->str != nullptr) {
+        screen_message(DBG_INVALID_LINE_LENGTH);
+        return false;
+    }
+#endif
+    if (src_line->str == nullptr) {
+        line->used = 0;
+        return true;
+    }
+    if (src_line->str_flink == nullptr) {
+        src_line->str_flink = src_line;
+        src_line->str_blink = src_line;
+    }
+    line->str = src_line->str;
+    line->str_flink = src_line->str_flink;
+    line->str_blink = src_line;
+    line->str_flink->str_blink = line;
+    src_line->str_flink = line;
+    if (line->group != nullptr)
+        line->group->frame->space_left += line->len - src_line->len;
+    line->len = src_line->len;
+    line->used = src_line->used;
+    return true;
+}
+
+bool line_unshare(line_ptr line) {
+    /*
+      Purpose  : Give a line a private copy of its text, if it is sharing
+                 the text with other lines.  Must be called before the text of
+                 the line is changed in place.
+      Inputs   : line: pointer to the line.
+      Outputs  : none.
+      Bugchecks: .line is nil
+    */
+
+#ifdef DEBUG
+    if (line == nullptr) {
+        screen_message(DBG_LINE_PTR_IS_NIL);
+        return false;
+    }
+#endif
+    if (line->str_flink == nullptr)
+        return true;
+    str_ptr new_str = new str_object(*line->str);
+    if (new_str == nullptr) {
+        screen_message(MSG_EXCEEDED_DYNAMIC_MEMORY);
+        return false;
+    }
+    line_str_release(line);
+    line->str = new_str;
+    return true;
+}
+
 bool line_to_number(line_ptr line, line_range &number) {
     /*
       Purpose  : Determine the line number of a given line.
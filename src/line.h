@@ -9,7 +9,10 @@ bool line_eop_destroy(group_ptr &group);
 bool lines_destroy(line_ptr &first_line, line_ptr &last_line);
 [[nodiscard]] bool lines_inject(line_ptr first_line, line_ptr last_line, line_ptr before_line);
 [[nodiscard]] bool lines_extract(line_ptr first_line, line_ptr last_line);
+[[nodiscard]] bool lines_move(line_ptr first_line, line_ptr last_line, line_ptr before_line);
 [[nodiscard]] bool line_change_length(line_ptr line, strlen_range new_length);
+[[nodiscard]] bool line_share(line_ptr line, line_ptr src_line);
+[[nodiscard]] bool line_unshare(line_ptr line);
 [[nodiscard]] bool line_to_number(line_ptr line, line_range &number);
 [[nodiscard]] bool line_from_number(frame_ptr frame, line_range nummber, line_ptr &line);
 
@@ -28,8 +28,11 @@
 #include "filesys.h"
 #include "frame.h"
 #include "fyle.h"
+#include "journal.h"
+#include "profile.h"
 #include "quit.h"
 #include "screen.h"
+#include "session.h"
 #include "sys.h"
 #include "user.h"
 #include "value.h"
@@ -58,25 +61,7 @@ void prog_windup(bool set_hangup) {
     quit_close_files();
 }
 
-void initialize() {
-    initial_tab_stops = DEFAULT_TAB_STOPS;
-
-    // Now create the Code Header for the compiler to use
-    code_top = 0;
-    code_list = new code_header;
-    // with code_list^ do
-    code_list->flink = code_list;
-    code_list->blink = code_list;
-    code_list->ref = 1;
-    code_list->code = 0;
-    code_list->len = 0;
-}
-
 bool start_up(int argc, char **argv) {
-    const std::string_view frame_name_cmd{"COMMAND"};
-    const std::string_view frame_name_oops{"OOPS"};
-    const std::string_view frame_name_heap{"HEAP"};
-
     bool result = false;
 
     // Get the command line.
@@ -98,10 +83,14 @@ bool start_up(int argc, char **argv) {
         goto l99;
 
     load_command_table(file_data.old_cmds);
+    if (!file_data.profile.empty())
+        profile_enable(file_data.profile);
 
     // Try to get started on the terminal.  If this fails assume carry on
     // in BATCH mode.
     ludwig_mode = ludwig_mode_type::ludwig_batch;
+    if (file_data.status_line)
+        vdu_reserve_status_line();
     if (vdu_init(terminal_info, tt_controlc, tt_winchanged)) {
         initial_scr_width = terminal_info.width;
         initial_scr_height = terminal_info.height;
@@ -120,32 +109,10 @@ bool start_up(int argc, char **argv) {
 
     scr_msg_row = terminal_info.height + 1;
 
-    // Create the three automatically defined frames: OOPS, COMMAND and LUDWIG.
-    // Save pointers to COMMAND & OOPS  frames for use in later frame routines.
-
-    if (!frame_edit(frame_name_oops))
+    // Create the three automatically defined frames: OOPS, COMMAND and HEAP,
+    // and the default frame LUDWIG.
+    if (!session_create_frames())
         goto l99;
-    if (!frame_setheight(initial_scr_height, true))
-        goto l99;
-    frame_oops = current_frame;
-    current_frame = nullptr;
-    frame_oops->space_limit = MAX_SPACE;     // Big !
-    frame_oops->space_left = MAX_SPACE - 50; // Big ! - space for <eop> line !!
-    frame_oops->options.insert(frame_options_elts::opt_special_frame);
-    if (!frame_edit(frame_name_cmd))
-        goto l99;
-    frame_cmd = current_frame;
-    current_frame = nullptr;
-    frame_cmd->options.insert(frame_options_elts::opt_special_frame);
-    if (!frame_edit(frame_name_heap))
-        goto l99;
-    frame_heap = current_frame;
-    current_frame = nullptr;
-    frame_heap->options.insert(frame_options_elts::opt_special_frame);
-    {
-        if (!frame_edit(DEFAULT_FRAME_NAME))
-            goto l99;
-    }
 
     if (ludwig_mode == ludwig_mode_type::ludwig_screen)
         screen_fixup();
@@ -174,12 +141,13 @@ bool start_up(int argc, char **argv) {
         if (ludwig_mode == ludwig_mode_type::ludwig_screen)
             vdu_flush();
     }
-    if (!file_page(current_frame, exit_abort))
+    if (!file_page(current_frame, exit_abort, file_data.window))
         goto l99;
     if (ludwig_mode != ludwig_mode_type::ludwig_batch)
         screen_clear_msgs(false);
     if (ludwig_mode == ludwig_mode_type::ludwig_screen)
         screen_fixup();
+    journal_open(current_frame); // After the fixup, so any message is seen without a pause.
 
     // Execute the user's initialization string.
 
@@ -212,8 +180,7 @@ l99:;
 
 int main(int argc, char **argv) {
     sys_initsig();
-    value_initializations();
-    initialize();               // Stuff VALUE can't do, like creating frames etc.
+    session_initialize();       // Editor state for the main thread's session.
     if (start_up(argc, argv)) { // Parse command line, get files attached, etc.
         execute_immed();
         sys_exit_success();
@@ -0,0 +1,158 @@
+/** @file ludwiglib.cpp
+ * Implementation of the interface for embedding Ludwig in other programs.
+ */
+
+#include "ludwiglib.h"
+
+#include "code.h"
+#include "line.h"
+#include "mark.h"
+#include "session.h"
+#include "var.h"
+
+#include <vector>
+
+namespace {
+
+    std::vector<std::string_view> split_lines(std::string_view text) {
+        // Break text at each newline, and split lines that are too long for
+        // Ludwig in the same way that filesys_read does.
+        std::vector<std::string_view> pieces;
+        while (!text.empty()) {
+            size_t nl = text.find('\n');
+            std::string_view line = text.substr(0, nl);
+            text = (nl == std::string_view::npos) ? std::string_view() : text.substr(nl + 1);
+            do {
+                pieces.push_back(line.substr(0, MAX_STRLEN));
+                line.remove_prefix(std::min<size_t>(line.size(), MAX_STRLEN));
+            } while (!line.empty());
+        }
+        return pieces;
+    }
+
+    bool make_lines(std::string_view text, line_ptr &first_line, line_ptr &last_line) {
+        // Create an unattached list of lines holding text.
+        const std::vector<std::string_view> pieces(split_lines(text));
+        first_line = nullptr;
+        last_line = nullptr;
+        if (pieces.empty())
+            return true;
+        if (!lines_create(pieces.size(), first_line, last_line))
+            return false;
+        line_ptr line = first_line;
+        for (const auto &piece : pieces) {
+            if (!piece.empty()) {
+                if (!line_change_length(line, piece.size())) {
+                    lines_destroy(first_line, last_line);
+                    return false;
+                }
+                line->str->copy_n(piece.data(), piece.size());
+            }
+            line->used = piece.size();
+            line = line->flink;
+        }
+        return true;
+    }
+
+} // namespace
+
+bool ludwiglib_open(bool old_cmds) {
+    // Prepare the calling thread's session for use as a transformation engine.
+    // A session that is already open is left alone, rather than set up again
+    // over the top of its frames and code.
+    if (code_list != nullptr)
+        return false;
+    return session_open_batch(old_cmds);
+}
+
+bool ludwiglib_set_text(std::string_view text) {
+    // Replace the whole text of the current frame, leaving the dot at the
+    // start of the first line.
+    frame_ptr frame = current_frame;
+    line_ptr first_line = frame->first_group->first_line;
+    line_ptr last_line = frame->last_group->last_line->blink;
+    if (last_line != nullptr) {
+        if (!marks_squeeze(first_line, 1, last_line->flink, 1))
+            return false;
+        if (!lines_extract(first_line, last_line))
+            return false;
+        if (!lines_destroy(first_line, last_line))
+            return false;
+    }
+    if (!make_lines(text, first_line, last_line))
+        return false;
+    if (first_line != nullptr) {
+        if (!lines_inject(first_line, last_line, frame->last_group->last_line))
+            return false;
+        if (!mark_create(first_line, 1, frame->dot))
+            return false;
+    }
+    frame->text_modified = false;
+    return true;
+}
+
+std::string ludwiglib_get_text() {
+    // Return the text of the current frame as a single buffer, with each
+    // line terminated by a newline.
+    const_line_ptr first_line = current_frame->first_group->first_line;
+    size_t size = 0;
+    for (const_line_ptr line = first_line; line->flink != nullptr; line = line->flink)
+        size += line->used + 1;
+    std::string text;
+    text.reserve(size);
+    for (const_line_ptr line = first_line; line->flink != nullptr; line = line->flink) {
+        if (line->used > 0)
+            text.append(line->str->slice(1, line->used));
+        text.push_back('\n');
+    }
+    return text;
+}
+
+code_ptr ludwiglib_compile(std::string_view commands) {
+    // Compile commands, returning nullptr if they contain errors.  The
+    // resulting code may be run any number of times, and must eventually be
+    // released with ludwiglib_discard.
+    span_object cmd_span;
+    cmd_span.flink = nullptr;
+    cmd_span.blink = nullptr;
+    cmd_span.frame = nullptr;
+    cmd_span.code = nullptr;
+    line_ptr first_line;
+    line_ptr last_line;
+    if (!make_lines(commands, first_line, last_line) || first_line == nullptr)
+        return nullptr;
+    cmd_span.mark_one = std::make_shared<mark_object>();
+    cmd_span.mark_one->line = first_line;
+    cmd_span.mark_one->col = 1;
+    cmd_span.mark_two = std::make_shared<mark_object>();
+    cmd_span.mark_two->line = last_line;
+    cmd_span.mark_two->col = last_line->used + 1;
+    bool compiled = code_compile(cmd_span, true);
+    exit_abort = false;
+    lines_destroy(first_line, last_line);
+    return compiled ? cmd_span.code : nullptr;
+}
+
+bool ludwiglib_run(code_ptr code) {
+    // Execute compiled code against the current frame.
+    bool result = code_interpret(leadparam::none, 1, code, true);
+    exit_abort = false;
+    tt_controlc = false;
+    return result;
+}
+
+void ludwiglib_discard(code_ptr &code) {
+    code_discard(code);
+}
+
+bool ludwiglib_transform(std::string_view commands, std::string_view text, std::string &result) {
+    // One shot transformation of text by commands.
+    code_ptr code = ludwiglib_compile(commands);
+    if (code == nullptr)
+        return false;
+    bool ok = ludwiglib_set_text(text) && ludwiglib_run(code);
+    if (ok)
+        result = ludwiglib_get_text();
+    ludwiglib_discard(code);
+    return ok;
+}
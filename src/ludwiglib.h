@@ -0,0 +1,41 @@
+/** @file ludwiglib.h
+ * Public interface for embedding Ludwig as an in-process text
+ * transformation engine.
+ *
+ * The calling thread's session (see session.h) is used, so each thread may
+ * run its own independent transformations.  The terminal is never
+ * initialised; messages are written to standard output as in batch mode.
+ * ludwiglib_open sets up the session, and fails if the calling thread's
+ * session is already open.
+ *
+ * Typical use:
+ *     ludwiglib_open(true);
+ *     code_ptr code = ludwiglib_compile("g/foo/ 1j");
+ *     for each buffer:
+ *         ludwiglib_set_text(buffer);
+ *         ludwiglib_run(code);
+ *         result = ludwiglib_get_text();
+ *     ludwiglib_discard(code);
+ */
+
+#ifndef LUDWIGLIB_H
+#define LUDWIGLIB_H
+
+#include "type.h"
+
+#include <string>
+#include <string_view>
+
+[[nodiscard]] bool ludwiglib_open(bool old_cmds);
+[[nodiscard]] bool ludwiglib_set_text(std::string_view text);
+[[nodiscard]] std::string ludwiglib_get_text();
+
+[[nodiscard]] code_ptr ludwiglib_compile(std::string_view commands);
+[[nodiscard]] bool ludwiglib_run(code_ptr code);
+void ludwiglib_discard(code_ptr &code);
+
+[[nodiscard]] bool ludwiglib_transform(
+    std::string_view commands, std::string_view text, std::string &result
+);
+
+#endif // !defined(LUDWIGLIB_H)
@@ -34,10 +34,10 @@
 #include <stdio.h>
 #include <string.h>
 
-size_t lwoptind = 1;  // index into parent argv vector
-int lwoptopt;         // character checked for validity
-bool lwoptreset;      // reset getopt
-std::string lwoptarg; // argument associated with option
+thread_local size_t lwoptind = 1;  // index into parent argv vector
+thread_local int lwoptopt;         // character checked for validity
+thread_local bool lwoptreset;      // reset getopt
+thread_local std::string lwoptarg; // argument associated with option
 
 #define BADCH (int)'?'
 #define BADARG (int)':'
@@ -48,7 +48,7 @@ std::string lwoptarg; // argument associated with option
  *  Parse argv argument vector.
  */
 int lwgetopt(const std::vector<std::string> &nargv, const std::string &ostr) {
-    static const char *place = EMSG; /* option letter processing */
+    static thread_local const char *place = EMSG; /* option letter processing */
     const char *oli;                 /* option letter list index */
 
     if (lwoptreset || *place == 0) {
@@ -37,9 +37,9 @@
 
 int lwgetopt(const std::vector<std::string> &argv, const std::string &opts);
 
-extern std::string lwoptarg;
-extern size_t lwoptind;
-extern int lwoptopt;
-extern bool lwoptreset;
+extern thread_local std::string lwoptarg;
+extern thread_local size_t lwoptind;
+extern thread_local int lwoptopt;
+extern thread_local bool lwoptreset;
 
 #endif /* !defined(LWGETOPT_H) */
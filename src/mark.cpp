@@ -27,7 +27,7 @@
 #include "screen.h"
 #include "var.h"
 
-size_t mark_object::allocated_marks = 0;
+thread_local size_t mark_object::allocated_marks = 0;
 
 namespace {
 
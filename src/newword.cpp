@@ -29,7 +29,77 @@
 #include "text.h"
 #include "var.h"
 
+#include <algorithm>
+#include <iterator>
+
+namespace {
+
+    using word_class_table = std::array<unsigned char, MAX_SET_RANGE + 1>;
+
+    const word_class_table &word_classes() {
+        /* Purpose  : Classify every character by the word set it belongs to.
+           Outputs  : For each character, the first word set containing it, or
+                      MAX_WORD_SETS if none does.  The table is rebuilt whenever
+                      word_elements changes.
+        */
+        thread_local std::array<accept_set_type, MAX_WORD_SETS> built_from;
+        thread_local word_class_table classes;
+        thread_local bool built = false;
+        if (!built || built_from != word_elements) {
+            for (int ch = 0; ch <= MAX_SET_RANGE; ++ch) {
+                int element = 0;
+                while ((element < MAX_WORD_SETS) && !word_elements[element].test(ch))
+                    element += 1;
+                classes[ch] = element;
+            }
+            built_from = word_elements;
+            built = true;
+        }
+        return classes;
+    }
+
+    int class_at(const word_class_table &classes, const_line_ptr line, col_range col) {
+        return classes[static_cast<unsigned char>(line->str->operator[](col))];
+    }
+
+    col_range class_end(
+        const word_class_table &classes, const_line_ptr line, col_range col, int limit, int element
+    ) {
+        /* Purpose  : Step forward over a run of characters of one class.
+           Outputs  : The first column from col on that is not of the class,
+                      or limit if every column before limit is.
+        */
+        if (col >= limit)
+            return col;
+        auto first = line->str->cbegin() + (col - 1);
+        auto last = line->str->cbegin() + (limit - 1);
+        auto pos = std::find_if(first, last, [&classes, element](char ch) {
+            return classes[static_cast<unsigned char>(ch)] != element;
+        });
+        return col + (pos - first);
+    }
+
+    col_range class_start(
+        const word_class_table &classes, const_line_ptr line, col_range col, int element
+    ) {
+        /* Purpose  : Step back over a run of characters of one class.
+           Outputs  : The nearest column at or before col that is not of the
+                      class, or 1 if every column after 1 is.
+        */
+        if (col <= 1)
+            return col;
+        auto first = std::make_reverse_iterator(line->str->cbegin() + col);
+        auto last = std::make_reverse_iterator(line->str->cbegin() + 1);
+        auto pos = std::find_if(first, last, [&classes, element](char ch) {
+            return classes[static_cast<unsigned char>(ch)] != element;
+        });
+        return col - (pos - first);
+    }
+
+} // namespace
+
 bool current_word(mark_ptr dot) {
+    const word_class_table &classes = word_classes();
     // with dot^ do
     if (dot->line->used + 2 < dot->col) {
         // check that we aren't past the last word in the para
@@ -44,9 +114,8 @@ bool current_word(mark_ptr dot) {
     // But were we in the blank line before a paragraph?
     if (dot->col == 0)
         return false;
-    while ((dot->col > 1) && word_elements[0].test(dot->line->str->operator[](dot->col)))
-        dot->col -= 1;
-    if (word_elements[0].test(dot->line->str->operator[](dot->col))) {
+    dot->col = class_start(classes, dot->line, dot->col, 0);
+    if (class_at(classes, dot->line, dot->col) == 0) {
         // we must have been somewhere on the line before the first word
         if (dot->line->blink == nullptr) // oops top of the frame reached
             return false;
@@ -56,18 +125,16 @@ bool current_word(mark_ptr dot) {
             return false;
     }
     // ASSERT: we now have dot sitting on part of a word
-    word_set_range element = 0;
-    while (!word_elements[element].test(dot->line->str->operator[](dot->col)))
-        element += 1;
+    int element = class_at(classes, dot->line, dot->col);
     // Now find the start of this word
-    while ((dot->col > 1) && word_elements[element].test(dot->line->str->operator[](dot->col)))
-        dot->col -= 1;
-    if (!word_elements[element].test(dot->line->str->operator[](dot->col)))
+    dot->col = class_start(classes, dot->line, dot->col, element);
+    if (class_at(classes, dot->line, dot->col) != element)
         dot->col += 1;
     return true;
 }
 
 bool next_word(mark_ptr dot) {
+    const word_class_table &classes = word_classes();
     // with dot^ do
     if (dot->col > dot->line->used) {
         // check that we aren't on a blank line
@@ -76,13 +143,9 @@ bool next_word(mark_ptr dot) {
         // All clear so fake it that we were at the end of the last word!
         dot->col = dot->line->used;
     }
-    word_set_range element = 0;
-    while (!word_elements[element].test(dot->line->str->operator[](dot->col)))
-        element += 1;
-    while ((dot->col < dot->line->used) &&
-           word_elements[element].test(dot->line->str->operator[](dot->col)))
-        dot->col += 1;
-    if (word_elements[element].test(dot->line->str->operator[](dot->col))) {
+    int element = class_at(classes, dot->line, dot->col);
+    dot->col = class_end(classes, dot->line, dot->col, dot->line->used, element);
+    if (class_at(classes, dot->line, dot->col) == element) {
         if (dot->line->flink == nullptr) // no more lines
             return false;
         if (dot->line->flink->used == 0) // end of paragraph
@@ -90,19 +153,16 @@ bool next_word(mark_ptr dot) {
         if (!mark_create(dot->line->flink, 1, dot))
             return false;
     }
-    while (word_elements[0].test(dot->line->str->operator[](dot->col)))
-        dot->col += 1;
+    dot->col = class_end(classes, dot->line, dot->col, dot->line->used, 0);
     return true;
 }
 
 bool previous_word(mark_ptr dot) {
+    const word_class_table &classes = word_classes();
     // with dot^ do
-    word_set_range element = 0;
-    while (!word_elements[element].test(dot->line->str->operator[](dot->col)))
-        element += 1;
-    while ((dot->col > 1) && word_elements[element].test(dot->line->str->operator[](dot->col)))
-        dot->col -= 1;
-    if (word_elements[element].test(dot->line->str->operator[](dot->col))) {
+    int element = class_at(classes, dot->line, dot->col);
+    dot->col = class_start(classes, dot->line, dot->col, element);
+    if (class_at(classes, dot->line, dot->col) == element) {
         if (dot->line->blink == nullptr) // no more lines
             return false;
         if (dot->line->blink->used == 0) // top of paragraph
@@ -288,13 +348,12 @@ l99:;
 }
 
 bool current_paragraph(mark_ptr dot) {
+    const word_class_table &classes = word_classes();
     line_ptr new_line = dot->line;
     col_range pos;
     if (dot->col < dot->line->used) {
-        pos = dot->col;
-        while ((pos > 1) && word_elements[0].test(new_line->str->operator[](pos)))
-            pos -= 1;
-        if (word_elements[0].test(new_line->str->operator[](pos))) {
+        pos = class_start(classes, new_line, dot->col, 0);
+        if (class_at(classes, new_line, pos) == 0) {
             if (new_line->blink == nullptr)
                 return false;
             else
@@ -309,26 +368,21 @@ bool current_paragraph(mark_ptr dot) {
         new_line = new_line->blink;
     if (new_line->used == 0)
         new_line = new_line->flink; // Oops too far!
-    pos = 1;
-    while (word_elements[0].test(new_line->str->operator[](pos)))
-        pos += 1;
+    pos = class_end(classes, new_line, 1, new_line->used, 0);
     if (!mark_create(new_line, pos, dot))
         return false;
     return true;
 }
 
 bool next_paragraph(mark_ptr dot) {
+    const word_class_table &classes = word_classes();
     line_ptr new_line = dot->line;
     col_range pos;
     if (dot->col < dot->line->used) {
-        pos = dot->col;
-        while ((pos > 1) && word_elements[0].test(new_line->str->operator[](pos)))
-            pos -= 1;
-        if (word_elements[0].test(new_line->str->operator[](pos))) {
+        pos = class_start(classes, new_line, dot->col, 0);
+        if (class_at(classes, new_line, pos) == 0) {
             if (new_line->blink == nullptr) {
-                dot->col = 1;
-                while (word_elements[0].test(new_line->str->operator[](dot->col)))
-                    dot->col += 1;
+                dot->col = class_end(classes, new_line, 1, new_line->used, 0);
                 return true;
             } else {
                 new_line = new_line->blink;
@@ -343,9 +397,7 @@ bool next_paragraph(mark_ptr dot) {
         new_line = new_line->flink;
     if (new_line->used == 0)
         return false;
-    pos = 1;
-    while (word_elements[0].test(new_line->str->operator[](pos)))
-        pos += 1;
+    pos = class_end(classes, new_line, 1, new_line->used, 0);
     if (!mark_create(new_line, pos, dot))
         return false;
     return true;
@@ -423,9 +475,7 @@ bool newword_advance_paragraph(leadparam rept, int count) {
             new_line = current_frame->first_group->first_line;
             while (new_line->used == 0)
                 new_line = new_line->flink;
-            col_range pos = 1;
-            while (word_elements[0].test(new_line->str->operator[](pos)))
-                pos += 1;
+            col_range pos = class_end(word_classes(), new_line, 1, new_line->used, 0);
             if (!mark_create(new_line, pos, current_frame->dot))
                 goto l98;
         }
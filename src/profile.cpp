@@ -0,0 +1,247 @@
+/** @file profile.cpp
+ * Collection and reporting of interpreter profiling data.
+ */
+
+#include "profile.h"
+
+#include "line.h"
+#include "sys.h"
+#include "var.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct profile_entry {
+    size_t calls = 0;
+    std::chrono::steady_clock::duration time{};
+    size_t lines = 0;
+};
+
+thread_local bool profile_enabled = false;
+
+namespace {
+    thread_local std::string report_name;
+    thread_local bool report_counts = false; // Write raw counts for profile_merge.
+    thread_local std::unordered_map<commands, profile_entry> command_profile;
+    thread_local std::map<std::string, profile_entry> span_profile;
+
+    std::string worker_file(const std::string &report_file, size_t worker) {
+        return report_file + "." + std::to_string(worker);
+    }
+
+    void write_entry(std::ostream &out, const profile_entry &entry) {
+        out << entry.calls << ' ' << entry.time.count() << ' ' << entry.lines;
+    }
+
+    bool read_entry(std::istream &in, profile_entry &entry) {
+        // Adds the counts read to entry.
+        size_t calls;
+        std::chrono::steady_clock::rep time;
+        size_t lines;
+        if (!(in >> calls >> time >> lines))
+            return false;
+        entry.calls += calls;
+        entry.time += std::chrono::steady_clock::duration(time);
+        entry.lines += lines;
+        return true;
+    }
+
+    bool write_counts(std::ostream &out) {
+        // One line per entry: C command calls time lines, or S calls time
+        // lines name, the name last as it may hold blanks.
+        for (const auto &[command, entry] : command_profile) {
+            out << "C " << static_cast<int>(command) << ' ';
+            write_entry(out, entry);
+            out << '\n';
+        }
+        for (const auto &[name, entry] : span_profile) {
+            out << "S ";
+            write_entry(out, entry);
+            out << ' ' << name << '\n';
+        }
+        return out.good();
+    }
+
+    line_range dot_line_nr(frame_ptr frame) {
+        line_range line_nr;
+        if (frame == nullptr || frame->dot == nullptr || frame->dot->line == nullptr ||
+            !line_to_number(frame->dot->line, line_nr))
+            return 0;
+        return line_nr;
+    }
+
+    bool command_name(commands command, int first, int last, std::string &name) {
+        // Search the expansion table of a prefix for command.
+        for (int i = first; i < last; ++i) {
+            const auto &exp = lookupexp[i];
+            if (exp.command == command) {
+                name.push_back(exp.extn);
+                return true;
+            }
+            auto nested = lookupexp_ptr.find(exp.command);
+            if (nested != lookupexp_ptr.end()) {
+                name.push_back(exp.extn);
+                if (command_name(command, nested->second.first, nested->second.second, name))
+                    return true;
+                name.pop_back();
+            }
+        }
+        return false;
+    }
+
+    std::string command_name(commands command) {
+        // Recover the characters that invoke command in the current command table.
+        std::string name;
+        for (int key = ' ' + 1; key < 127; ++key) {
+            commands key_command = lookup[key].command;
+            if (key_command == command)
+                return std::string(1, static_cast<char>(key));
+            auto exp = lookupexp_ptr.find(key_command);
+            if (exp != lookupexp_ptr.end()) {
+                name.assign(1, static_cast<char>(key));
+                if (command_name(command, exp->second.first, exp->second.second, name))
+                    return name;
+            }
+        }
+        return "#" + std::to_string(static_cast<int>(command));
+    }
+
+    void write_table(
+        std::ostream &out,
+        const std::string &title,
+        std::vector<std::pair<std::string, const profile_entry *>> &rows
+    ) {
+        std::ranges::sort(rows, [](const auto &a, const auto &b) {
+            return a.second->time > b.second->time;
+        });
+        out << title << '\n';
+        out << std::setw(24) << std::left << "Name" << std::right << std::setw(12) << "Calls"
+            << std::setw(14) << "Total ms" << std::setw(12) << "Avg us" << std::setw(12)
+            << "Lines" << '\n';
+        for (const auto &[name, entry] : rows) {
+            using namespace std::chrono;
+            double total_ms = duration<double, std::milli>(entry->time).count();
+            double avg_us = duration<double, std::micro>(entry->time).count() / entry->calls;
+            out << std::setw(24) << std::left << name << std::right << std::setw(12)
+                << entry->calls << std::fixed << std::setprecision(3) << std::setw(14)
+                << total_ms << std::setw(12) << avg_us << std::setw(12) << entry->lines << '\n';
+        }
+        out << '\n';
+    }
+}; // namespace
+
+void profile_enable(const std::string &report_file) {
+    report_name = report_file;
+    report_counts = false;
+    command_profile.clear();
+    span_profile.clear();
+    profile_enabled = true;
+}
+
+bool profile_report() {
+    // Write the collected profile, most expensive entries first.
+    if (!profile_enabled)
+        return true;
+    std::ofstream out(report_name);
+    if (!out)
+        return false;
+    if (report_counts)
+        return write_counts(out);
+    std::vector<std::pair<std::string, const profile_entry *>> rows;
+    for (const auto &[command, entry] : command_profile)
+        rows.emplace_back(command_name(command), &entry);
+    write_table(out, "Commands", rows);
+    rows.clear();
+    for (const auto &[name, entry] : span_profile)
+        rows.emplace_back(name, &entry);
+    write_table(out, "Spans", rows);
+    return out.good();
+}
+
+void profile_worker(size_t worker) {
+    // Called in a batch worker, so that it leaves its counts for the parent
+    // rather than overwriting the report.  The counts already collected
+    // belong to the parent.  Any file left by an earlier run is emptied
+    // at once, in case this worker dies before it can write its own.
+    if (!profile_enabled)
+        return;
+    report_name = worker_file(report_name, worker);
+    report_counts = true;
+    command_profile.clear();
+    span_profile.clear();
+    std::ofstream(report_name).flush();
+}
+
+bool profile_merge(size_t worker) {
+    // Add the counts left by a finished batch worker to our own.
+    if (!profile_enabled)
+        return true;
+    std::string name = worker_file(report_name, worker);
+    std::ifstream in(name);
+    if (!in)
+        return false;
+    bool ok = true;
+    std::string line;
+    while (ok && std::getline(in, line)) {
+        std::istringstream fields(line);
+        char kind = 0;
+        fields >> kind;
+        if (kind == 'C') {
+            int command;
+            ok = (fields >> command) &&
+                 read_entry(fields, command_profile[static_cast<commands>(command)]);
+        } else if (kind == 'S') {
+            profile_entry entry;
+            std::string span_name;
+            ok = read_entry(fields, entry) && fields.get() == ' ' &&
+                 std::getline(fields, span_name);
+            if (ok) {
+                profile_entry &total = span_profile[span_name];
+                total.calls += entry.calls;
+                total.time += entry.time;
+                total.lines += entry.lines;
+            }
+        } else {
+            ok = false;
+        }
+    }
+    in.close();
+    sys_unlink(name);
+    return ok;
+}
+
+profile_scope::profile_scope(commands command)
+    : entry(profile_enabled ? &command_profile[command] : nullptr) {
+    if (entry != nullptr) {
+        frame = current_frame;
+        line_nr = dot_line_nr(frame);
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+profile_scope::profile_scope(const std::string &span_name)
+    : entry(profile_enabled ? &span_profile[span_name] : nullptr) {
+    if (entry != nullptr) {
+        frame = current_frame;
+        line_nr = dot_line_nr(frame);
+        start = std::chrono::steady_clock::now();
+    }
+}
+
+profile_scope::~profile_scope() {
+    // Lines touched is the distance the dot travelled through its frame.
+    if (entry != nullptr) {
+        entry->time += std::chrono::steady_clock::now() - start;
+        entry->calls += 1;
+        if (current_frame == frame) {
+            line_range end_nr = dot_line_nr(frame);
+            entry->lines += (end_nr > line_nr ? end_nr - line_nr : line_nr - end_nr) + 1;
+        }
+    }
+}
@@ -0,0 +1,44 @@
+/** @file profile.h
+ * Optional profiling of the command interpreter.
+ *
+ * When profiling is enabled (-P file), every command executed and every
+ * span run is timed, and a report sorted by cumulative time is written to
+ * the file when Ludwig exits.  Times are inclusive, so a span execution
+ * command includes the time of the commands in the span.
+ *
+ * Batch workers (-p) each write their counts to a file of their own, which
+ * the parent adds to its own counts once the worker has finished.
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "type.h"
+
+#include <chrono>
+
+extern thread_local bool profile_enabled;
+
+void profile_enable(const std::string &report_file);
+bool profile_report();
+void profile_worker(size_t worker);
+bool profile_merge(size_t worker);
+
+// Records a command or span execution from construction to destruction.
+class profile_scope {
+public:
+    explicit profile_scope(commands command);
+    explicit profile_scope(const std::string &span_name);
+    ~profile_scope();
+
+    profile_scope(const profile_scope &) = delete;
+    profile_scope &operator=(const profile_scope &) = delete;
+
+private:
+    struct profile_entry *entry;
+    std::chrono::steady_clock::time_point start;
+    frame_ptr frame;
+    line_range line_nr;
+};
+
+#endif // !defined(PROFILE_H)
@@ -26,7 +26,9 @@
 
 #include "const.h"
 #include "fyle.h"
+#include "journal.h"
 #include "mark.h"
+#include "profile.h"
 #include "screen.h"
 #include "sys.h"
 #include "var.h"
@@ -102,6 +104,8 @@ bool do_frame(frame_ptr f) {
     bool result = true;
     if (!ludwig_aborted) {
         result = file_close_delete(files[f->output_file], !f->text_modified, f->text_modified);
+        if (result)
+            journal_close(f);
     }
     f->output_file = -1;
     return result;
@@ -141,4 +145,6 @@ l99:;
         screen_message(MSG_NOT_RENAMED);
         screen_message(MSG_ABORT);
     }
+    if (!profile_report())
+        screen_message(MSG_CANT_WRITE_PROFILE);
 }
@@ -41,19 +41,172 @@
 //  FRAME.SCR_OFFSET      -- To find the column number on the screen
 //                           from the column number of a character in
 //                           a line of a frame, subtract this value.
+//
+//  VIEWPORTS             -- Frames with the V option, each shown below
+//                           the rows used by the current frame, with its
+//                           own first line, offset, and copy of what is
+//                           on its rows.
 
 #include "line.h"
 #include "var.h"
 #include "vdu.h"
 
+#include <algorithm>
 #include <cstring>
 #include <iomanip>
 #include <iostream>
+#include <string>
+#include <vector>
 
 enum class slide_type { slide_dont, slide_left, slide_right, slide_redraw };
 
 enum class scroll_type { scroll_dont, scroll_forward, scroll_back, scroll_redraw };
 
+namespace {
+
+    // What the status line is showing, so that it is only rewritten when
+    // one of the fields changes.
+    struct status_fields {
+        bool valid;
+        std::string name;
+        line_range line_nr;
+        col_range col;
+        bool modified;
+    };
+    thread_local status_fields status_shown{};
+
+    // A frame kept on view below the current frame.  Only the rows whose
+    // text differs from what was last drawn there are written again.
+    struct viewport {
+        frame_ptr frame;
+        scr_row_range first_row;        // The frame name is shown on this row,
+        scr_row_range rows;             // followed by this many rows of text.
+        line_range top_nr;              // Line on the first row, 0 if not yet placed.
+        int offset;                     // Like frame.scr_offset.
+        bool drawn;                     // False until the rows have been written.
+        std::string title;              // As last drawn.
+        std::vector<std::string> shown; // As last drawn.
+    };
+    thread_local std::vector<frame_ptr> viewport_frames; // With V set, when laid out.
+    thread_local std::vector<viewport> viewports;
+
+    std::vector<frame_ptr> find_viewport_frames() {
+        std::vector<frame_ptr> frames;
+        for (span_ptr span = first_span; span != nullptr; span = span->flink) {
+            if (span->frame != nullptr &&
+                span->frame->options.contains(frame_options_elts::opt_viewport))
+                frames.push_back(span->frame);
+        }
+        return frames;
+    }
+
+    int viewports_layout(int height) {
+        // Share at most half the height between the viewports, with room
+        // for the name and at least one line in each, and return the rows
+        // left for the current frame.  Viewports that are still wanted keep
+        // their position in their frame.
+
+        viewport_frames = find_viewport_frames();
+        int space = height / 2;
+        int count = std::min<int>(viewport_frames.size(), space / 2);
+        std::vector<viewport> laid;
+        if (count > 0) {
+            int each = space / count;
+            int row = height - count * each + 1;
+            for (int i = 0; i < count; ++i) {
+                frame_ptr frame = viewport_frames[i];
+                auto old = std::find_if(viewports.begin(), viewports.end(), [&](const viewport &v) {
+                    return v.frame == frame;
+                });
+                laid.push_back({frame, row, each - 1, 0, 0, false, {}, {}});
+                if (old != viewports.end()) {
+                    laid.back().top_nr = old->top_nr;
+                    laid.back().offset = old->offset;
+                }
+                row += each;
+            }
+            height -= count * each;
+        }
+        viewports = std::move(laid);
+        return height;
+    }
+
+    bool viewports_changed() {
+        return find_viewport_frames() != viewport_frames;
+    }
+
+    bool viewport_draw(viewport &v) {
+        // Bring the viewport up to date, keeping its frame's dot on view,
+        // and return true if anything was written.
+
+        const frame_ptr frame = v.frame;
+        line_range dot_nr;
+        if (!line_to_number(frame->dot->line, dot_nr))
+            return false;
+        line_range eop_nr = frame->last_group->first_line_nr + frame->last_group->nr_lines - 1;
+        if (v.top_nr == 0)
+            v.top_nr = (dot_nr > v.rows / 2) ? dot_nr - v.rows / 2 : 1;
+        else if (dot_nr < v.top_nr)
+            v.top_nr = dot_nr;
+        else if (dot_nr >= v.top_nr + v.rows)
+            v.top_nr = dot_nr - v.rows + 1;
+        if (v.top_nr > eop_nr)
+            v.top_nr = eop_nr;
+        int width = terminal_info.width;
+        int half_width = std::max(width / 2, 1);
+        while (frame->dot->col <= v.offset)
+            v.offset = (v.offset > half_width) ? v.offset - half_width : 0;
+        while (frame->dot->col > v.offset + width)
+            v.offset += half_width;
+
+        bool written = false;
+        std::string title = "-- " + frame->span->name + " ";
+        title.resize(std::max<size_t>(width, title.size()), '-');
+        if (!v.drawn || title != v.title) {
+            vdu_movecurs(1, v.first_row);
+            vdu_attr_bold();
+            vdu_displaystr(title, 3);
+            vdu_attr_normal();
+            v.title = title;
+            written = true;
+        }
+        line_ptr line;
+        if (!line_from_number(frame, v.top_nr, line))
+            return written;
+        v.shown.resize(v.rows);
+        for (int i = 0; i < v.rows; ++i) {
+            std::string_view text;
+            if (line != nullptr) {
+                int offset = v.offset;
+                int len;
+                if (line->flink != nullptr) {
+                    len = line->used - offset;
+                } else {
+                    len = line->len;
+                    offset = 0;
+                }
+                if (len > width)
+                    len = width;
+                if (len > 0)
+                    text = line->str->slice(offset + 1, len);
+                line = line->flink;
+            }
+            if (!v.drawn || text != v.shown[i]) {
+                vdu_movecurs(1, v.first_row + 1 + i);
+                if (text.empty())
+                    vdu_cleareol();
+                else
+                    vdu_displaystr(text, 3);
+                v.shown[i] = text;
+                written = true;
+            }
+        }
+        v.drawn = true;
+        return written;
+    }
+
+} // namespace
+
 const char PAUSE_MSG[] = "Pausing until RETURN pressed: ";
 const char YNAQM_MSG[] = "Reply Y(es),N(o),A(lways),Q(uit),M(ore)";
 const std::string YNAQM_CHARS(" YNAQM123456789");
@@ -110,6 +263,7 @@ void screen_message(const std::string_view &message) {
             vdu_attr_normal();
             i += j;
         } while (i < message.size());
+        vdu_flush(); // Messages may precede a long operation.
     } else {
         /* if (ludwig_mode = ludwig_mode_type::ludwig_hardcopy) */
         /*     putchar(7); */
@@ -119,6 +273,11 @@ void screen_message(const std::string_view &message) {
 
 void screen_draw_line(line_ptr line) {
     // Draw a line if it is on the screen.
+    // The visible part of the line is passed to the vdu as a view into the
+    // line's own string, characters are displayed as they are stored, so
+    // there is no row text to build, and none is cached.  The cost of
+    // drawing a line again is in the terminal output, which the vdu backend
+    // keeps to the cells that have changed.
 
 #ifdef DEBUG
     if (line->scr_row_nr == 0) {
@@ -168,43 +327,19 @@ void screen_slide_line(line_ptr line, int slide_dist, slide_type slide_state) {
     //      AND FOR                              SCREEN_SLIDE.
     // It assumes the scr_offset has been changed by slide_dist
     // and that the lines on the screen are being accordingly fixed.
+    // The row is rewritten in one go from the new slice of the line, rather
+    // than shuffled a character at a time, and the update of the terminal
+    // is left to work out the cheapest way of showing the shifted text.
 
     if (line->flink == nullptr)
         return; // Dont slide NULL line.
 
     col_offset_range offset = scr_frame->scr_offset;
-    scr_col_range width = scr_frame->scr_width;
-
-    // with line^ do
-    vdu_movecurs(1, line->scr_row_nr);
-    if (slide_state == slide_type::slide_left) {
-        int overlap = line->used - offset;
-        if (overlap > 0) {
-            if (overlap > slide_dist) {
-                vdu_insertchars(slide_dist);
-                overlap = slide_dist;
-            }
-            vdu_displaystr(line->str->slice(offset + 1, overlap), 2 /*anycurs*/);
-        }
-    } else {
-        if (offset - slide_dist < line->used) {
-            int overlap = line->used /*+ 1*/ - (offset - slide_dist + width /*+ 1*/);
-            if (slide_dist >= width) {
-                vdu_cleareol();
-                slide_dist = width;
-            } else {
-                vdu_deletechars(slide_dist);
-                vdu_movecurs(width + 1 - slide_dist, line->scr_row_nr);
-            }
-            if (overlap > 0) {
-                if (overlap > slide_dist)
-                    overlap = slide_dist;
-                vdu_displaystr(
-                    line->str->slice(offset + width + 1 - slide_dist + 1, overlap), 2 /*anycurs*/
-                );
-            }
-        }
-    }
+    int old_offset =
+        (slide_state == slide_type::slide_left) ? offset + slide_dist : offset - slide_dist;
+    if (line->used <= std::min<int>(offset, old_offset))
+        return; // Nothing visible before or after.
+    screen_draw_line(line);
 }
 
 void screen_slide(int dist) {
@@ -795,6 +930,8 @@ void screen_load(line_ptr line) {
 
             // with line->group->frame^ do
             int new_row = frame->scr_dot_line;
+            if (new_row > terminal_info.height) // The screen has shrunk since.
+                new_row = terminal_info.height;
             line_range line_nr;
             if (!line_to_number(line, line_nr))
                 return;
@@ -1087,6 +1224,9 @@ void screen_resize() {
 
     tt_winchanged = false;
     vdu_get_new_dimensions(terminal_info.width, terminal_info.height);
+    terminal_info.height = viewports_layout(terminal_info.height);
+    vdu_set_region(terminal_info.height);
+    status_shown.valid = false;
     scr_msg_row = terminal_info.height + 1;
     vdu_clearscr();
     // change the screen height, width, and margins of all the frames
@@ -1120,6 +1260,59 @@ void screen_resize() {
     );
 }
 
+bool screen_type_ahead() {
+    // True if a command has already been typed, so that there is no point in
+    // bringing the screen up to date before it is executed.  Text that will
+    // be echoed onto the screen needs the screen to be correct, as do any
+    // messages waiting to be read.
+
+    if (scr_msg_row <= terminal_info.height)
+        return false;
+    key_code_range key;
+    if (!vdu_key_pending(key))
+        return false;
+    return edit_mode == mode_type::mode_command || key < 0 || !PRINTABLE_SET.test(key) ||
+           key == command_introducer;
+}
+
+void screen_status() {
+    // Bring the status line, if there is one, up to date with the current
+    // frame: its name, the line and column of the dot, and whether it has
+    // been modified.
+
+    if (current_frame == nullptr || current_frame->span == nullptr)
+        return;
+    line_range line_nr;
+    if (!line_to_number(current_frame->dot->line, line_nr))
+        return;
+    const std::string &name = current_frame->span->name;
+    col_range col = current_frame->dot->col;
+    bool modified = current_frame->text_modified;
+    if (status_shown.valid && status_shown.line_nr == line_nr && status_shown.col == col &&
+        status_shown.modified == modified && status_shown.name == name)
+        return;
+    status_shown = {true, name, line_nr, col, modified};
+
+    std::string text = " " + name + "  Line " + std::to_string(line_nr) +
+                       "  Col " + std::to_string(col);
+    if (modified)
+        text += "  Modified";
+    vdu_display_status(text);
+}
+
+void screen_viewports() {
+    // Bring the viewports up to date, leaving the cursor at the dot.
+
+    bool written = false;
+    for (viewport &v : viewports)
+        written = viewport_draw(v) || written;
+    if (written)
+        vdu_movecurs(
+            current_frame->dot->col - current_frame->scr_offset,
+            current_frame->dot->line->scr_row_nr
+        );
+}
+
 void screen_fixup() {
     // Make sure that the screen is user's view of the screen is correct.
 
@@ -1129,7 +1322,7 @@ void screen_fixup() {
         return;
     }
 #endif
-    if (tt_winchanged) {
+    if (tt_winchanged || viewports_changed()) {
         screen_resize();
     } else {
         // with current_frame^,dot^ do
@@ -1170,6 +1363,8 @@ void screen_fixup() {
             current_frame->dot->line->scr_row_nr
         );
     }
+    screen_viewports();
+    screen_status();
 }
 
 void screen_getlinep(
@@ -17,6 +17,9 @@ void screen_position(line_ptr new_line, col_range new_col);
 void screen_pause();
 void screen_clear_msgs(bool pause);
 void screen_fixup();
+[[nodiscard]] bool screen_type_ahead();
+void screen_viewports();
+void screen_status();
 void screen_getlinep(
     const std::string_view &prompt,
     str_object &outbuf,
@@ -0,0 +1,89 @@
+/** @file session.cpp
+ * Creation and tear-down of independent editing sessions.
+ */
+
+#include "session.h"
+
+#include "frame.h"
+#include "quit.h"
+#include "undo.h"
+#include "value.h"
+#include "var.h"
+
+void session_initialize() {
+    // Set up the calling thread's editor state.  Must be called on a thread
+    // before any other Ludwig routine is used on it.
+    value_initializations();
+    initial_tab_stops = DEFAULT_TAB_STOPS;
+    undo_initialize();
+
+    // Now create the Code Header for the compiler to use
+    code_top = 0;
+    code_list = new code_header;
+    // with code_list^ do
+    code_list->flink = code_list;
+    code_list->blink = code_list;
+    code_list->ref = 1;
+    code_list->code = 0;
+    code_list->len = 0;
+}
+
+bool session_create_frames() {
+    // Create the three automatically defined frames: OOPS, COMMAND and HEAP,
+    // followed by the default frame, which is left as the current frame.
+    // Save pointers to COMMAND & OOPS  frames for use in later frame routines.
+    const std::string_view frame_name_cmd{"COMMAND"};
+    const std::string_view frame_name_oops{"OOPS"};
+    const std::string_view frame_name_heap{"HEAP"};
+
+    if (!frame_edit(frame_name_oops))
+        return false;
+    if (!frame_setheight(initial_scr_height, true))
+        return false;
+    frame_oops = current_frame;
+    current_frame = nullptr;
+    frame_oops->space_limit = MAX_SPACE;     // Big !
+    frame_oops->space_left = MAX_SPACE - 50; // Big ! - space for <eop> line !!
+    frame_oops->options.insert(frame_options_elts::opt_special_frame);
+    if (!frame_edit(frame_name_cmd))
+        return false;
+    frame_cmd = current_frame;
+    current_frame = nullptr;
+    frame_cmd->options.insert(frame_options_elts::opt_special_frame);
+    if (!frame_edit(frame_name_heap))
+        return false;
+    frame_heap = current_frame;
+    current_frame = nullptr;
+    frame_heap->options.insert(frame_options_elts::opt_special_frame);
+    return frame_edit(DEFAULT_FRAME_NAME);
+}
+
+bool session_open_batch(bool old_cmds) {
+    // Set up a complete batch mode session on the calling thread, ready to
+    // accept commands.  The terminal is never touched.
+    session_initialize();
+    ludwig_mode = ludwig_mode_type::ludwig_batch;
+    vdu_free_flag = true;     // The terminal belongs to the main thread.
+    terminal_info.width = 80; // As vdu_init leaves it when there is no terminal.
+    terminal_info.height = 4;
+    file_data.old_cmds = old_cmds;
+    load_command_table(old_cmds);
+    return session_create_frames();
+}
+
+void session_close() {
+    // Wind out and close every file attached to the session's frames.
+    ludwig_aborted = false;
+    quit_close_files();
+}
+
+std::future<bool> session_start(std::function<bool()> body) {
+    // Run body on a new thread in a fresh batch mode session with its
+    // frames already created.  The session's files are closed when body
+    // returns, and the future yields body's result.
+    return std::async(std::launch::async, [body = std::move(body)]() {
+        bool result = session_open_batch(true) && body();
+        session_close();
+        return result;
+    });
+}
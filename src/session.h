@@ -0,0 +1,24 @@
+/** @file session.h
+ * Independent editing sessions.
+ *
+ * All of the editor state declared in var.h is thread local, so each
+ * thread hosts exactly one session, with its own frames, spans, files,
+ * compiled code and structure pools.  Sessions on different threads share
+ * nothing and can run concurrently.  Only the main thread may drive the
+ * terminal; sessions started by session_start always run in batch mode.
+ */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <functional>
+#include <future>
+
+void session_initialize();
+[[nodiscard]] bool session_create_frames();
+[[nodiscard]] bool session_open_batch(bool old_cmds);
+void session_close();
+
+[[nodiscard]] std::future<bool> session_start(std::function<bool()> body);
+
+#endif // !defined(SESSION_H)
@@ -24,6 +24,7 @@ struct file_status {
     bool valid;
     int mode;
     long mtime;
+    long size;
     bool isdir;
 };
 
@@ -35,8 +36,16 @@ int sys_open_file(const std::string &filename);
 int sys_create_file(const std::string &filename);
 long sys_read(int fd, void *buf, size_t count);
 long sys_write(int fd, const void *buf, size_t count);
+// Copy count bytes from in_offset in one file to the current position in
+// another, sharing storage where the filesystem can.  Returns the number of
+// bytes copied, which is short if the copy could not be done in the kernel.
+long sys_copy_range(int in_fd, long in_offset, int out_fd, size_t count);
 int sys_close(int fd);
 bool sys_seek(int fd, long where);
+// Cut the file to length bytes, and position at its end.
+bool sys_truncate(int fd, long length);
+// Wait until what has been written to the file is on disk.
+bool sys_sync(int fd);
 long sys_tell(int fd);
 
 [[nodiscard]] bool sys_file_exists(const std::string &filename);
@@ -52,6 +61,10 @@ bool sys_rename(const std::string &oldname, const std::string &newname);
 bool sys_chmod(const std::string &filename, int mask);
 void sys_reap_children();
 
+// Worker processes
+[[nodiscard]] long sys_fork_worker();
+[[nodiscard]] long sys_wait_worker(bool &success);
+
 std::vector<long> sys_list_backups(const std::string &filename);
 
 #endif // !defined(SYS_H)
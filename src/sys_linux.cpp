@@ -22,25 +22,113 @@
 #include "sys.h"
 
 #include <algorithm>
+#include <cerrno>
 #include <charconv>
 #include <fcntl.h>
 #include <filesystem>
 #include <pwd.h>
 #include <signal.h>
+#include <string_view>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <sys/wait.h>
 #include <unistd.h>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace fs = std::filesystem;
 
 namespace {
     const std::string NL("\n");
 
+    // Worker processes started and not yet waited for.  Only these are
+    // waited for, any other children are left for whoever started them.
+    thread_local std::vector<pid_t> workers;
+
     void do_exit(int status) {
         // Here would be the spot to tear-down what sys_initsig did.
         ::exit(status);
     }
+
+    // Backup version lists found in a directory, keyed by backup name.
+    // They are only used while the directory's modification time is the
+    // one it had when they were found, or when we last changed it.  A change
+    // by another process within the same clock tick as one of ours leaves
+    // the time alone, and some filesystems only keep it to the second, so a
+    // list is also checked for a new last version before it is used.
+    struct backup_dir {
+        timespec mtime;
+        std::unordered_map<std::string, std::vector<long>> versions;
+    };
+
+    thread_local std::unordered_map<std::string, backup_dir> backup_cache;
+
+    std::pair<std::string, std::string> split_path(const std::string &filename) {
+        fs::path p(filename);
+        fs::path dir = p.parent_path();
+        if (dir.empty())
+            dir = ".";
+        return {dir.string(), p.filename().string()};
+    }
+
+    bool dir_mtime(const std::string &dir, timespec &mtime) {
+        struct stat st;
+        if (stat(dir.c_str(), &st) != 0)
+            return false;
+        mtime = st.st_mtim;
+        return true;
+    }
+
+    bool same_mtime(const timespec &a, const timespec &b) {
+        return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+    }
+
+    bool backup_version(std::string_view name, std::string_view bname, long &version) {
+        // Is name bname followed by a version number?
+        if (name.size() <= bname.size() || !name.starts_with(bname))
+            return false;
+        std::string_view suffix = name.substr(bname.size());
+        version = 0;
+        auto res = std::from_chars(suffix.data(), suffix.data() + suffix.size(), version);
+        return res.ptr == suffix.data() + suffix.size();
+    }
+
+    bool backups_current(const std::string &dir) {
+        // Called before we change dir.  Are its cached backup lists still
+        // up to date?  Stale ones are dropped.
+        auto it = backup_cache.find(dir);
+        if (it == backup_cache.end())
+            return false;
+        timespec mtime;
+        if (dir_mtime(dir, mtime) && same_mtime(mtime, it->second.mtime))
+            return true;
+        backup_cache.erase(it);
+        return false;
+    }
+
+    void backups_changed(const std::string &dir, const std::string &name, bool added) {
+        // Called after we have added or removed name in dir, where the cached
+        // lists were up to date just before.  Brings them up to date again.
+        auto it = backup_cache.find(dir);
+        if (it == backup_cache.end())
+            return;
+        if (!dir_mtime(dir, it->second.mtime)) {
+            backup_cache.erase(it);
+            return;
+        }
+        for (auto &[bname, versions] : it->second.versions) {
+            long version;
+            if (!backup_version(name, bname, version))
+                continue;
+            auto pos = std::lower_bound(versions.begin(), versions.end(), version);
+            bool present = pos != versions.end() && *pos == version;
+            if (added && !present)
+                versions.insert(pos, version);
+            else if (!added && present)
+                versions.erase(pos);
+        }
+    }
 }; // namespace
 
 bool sys_suspend() {
@@ -148,7 +236,12 @@ int sys_open_file(const std::string &filename) {
 }
 
 int sys_create_file(const std::string &filename) {
-    return ::open(filename.c_str(), O_RDWR | O_CREAT, 0600);
+    auto [dir, name] = split_path(filename);
+    bool cached = backups_current(dir);
+    int fd = ::open(filename.c_str(), O_RDWR | O_CREAT, 0600);
+    if (fd >= 0 && cached)
+        backups_changed(dir, name, true);
+    return fd;
 }
 
 int sys_file_mask() {
@@ -208,6 +301,41 @@ void sys_reap_children() {
     }
 }
 
+long sys_fork_worker() {
+    pid_t pid = ::fork();
+    if (pid > 0)
+        workers.push_back(pid);
+    else if (pid == 0)
+        workers.clear();
+    return pid;
+}
+
+long sys_wait_worker(bool &success) {
+    // Take a worker that has already finished if there is one, otherwise
+    // block until the oldest one does.
+    success = false;
+    if (workers.empty())
+        return -1;
+    auto it = workers.begin();
+    int pstat;
+    pid_t pid = 0;
+    for (auto worker = workers.begin(); worker != workers.end() && pid == 0; ++worker) {
+        pid = ::waitpid(*worker, &pstat, WNOHANG);
+        if (pid != 0)
+            it = worker;
+    }
+    if (pid == 0) {
+        do {
+            pid = ::waitpid(*it, &pstat, 0);
+        } while (pid < 0 && errno == EINTR);
+    }
+    // A worker that can't be waited for has failed.
+    pid_t worker = *it;
+    workers.erase(it);
+    success = pid > 0 && WIFEXITED(pstat) && WEXITSTATUS(pstat) == EXIT_SUCCESS;
+    return worker;
+}
+
 long sys_read(int fd, void *buf, size_t count) {
     return ::read(fd, buf, count);
 }
@@ -216,16 +344,44 @@ long sys_write(int fd, const void *buf, size_t count) {
     return ::write(fd, buf, count);
 }
 
+long sys_copy_range(int in_fd, long in_offset, int out_fd, size_t count) {
+    off_t offset = in_offset;
+    size_t copied = 0;
+    while (copied < count) {
+        ssize_t n = ::copy_file_range(in_fd, &offset, out_fd, nullptr, count - copied, 0);
+        if (n <= 0)
+            break;
+        copied += n;
+    }
+    return copied;
+}
+
 int sys_close(int fd) {
     return ::close(fd);
 }
 
 bool sys_unlink(const std::string &filename) {
-    return ::unlink(filename.c_str()) == 0;
+    auto [dir, name] = split_path(filename);
+    bool cached = backups_current(dir);
+    if (::unlink(filename.c_str()) != 0)
+        return false;
+    if (cached)
+        backups_changed(dir, name, false);
+    return true;
 }
 
 bool sys_rename(const std::string &oldname, const std::string &newname) {
-    return ::rename(oldname.c_str(), newname.c_str()) == 0;
+    auto [old_dir, old_name] = split_path(oldname);
+    auto [new_dir, new_name] = split_path(newname);
+    bool old_cached = backups_current(old_dir);
+    bool new_cached = (new_dir == old_dir) ? old_cached : backups_current(new_dir);
+    if (::rename(oldname.c_str(), newname.c_str()) != 0)
+        return false;
+    if (old_cached)
+        backups_changed(old_dir, old_name, false);
+    if (new_cached)
+        backups_changed(new_dir, new_name, true);
+    return true;
 }
 
 bool sys_chmod(const std::string &filename, int mask) {
@@ -233,7 +389,15 @@ bool sys_chmod(const std::string &filename, int mask) {
 }
 
 bool sys_seek(int fd, long where) {
-    return ::lseek(fd, where, L_SET) == 0;
+    return ::lseek(fd, where, L_SET) == where;
+}
+
+bool sys_truncate(int fd, long length) {
+    return ::ftruncate(fd, length) == 0 && ::lseek(fd, length, SEEK_SET) == length;
+}
+
+bool sys_sync(int fd) {
+    return ::fsync(fd) == 0;
 }
 
 long sys_tell(int fd) {
@@ -245,6 +409,7 @@ file_status sys_file_status(const std::string &filename) {
     fs.valid = false;
     fs.mode = 0600;
     fs.mtime = -1;
+    fs.size = 0;
     fs.isdir = false;
 
     struct stat st;
@@ -253,40 +418,52 @@ file_status sys_file_status(const std::string &filename) {
     fs.valid = true;
     fs.mode = st.st_mode & 07777;
     fs.mtime = st.st_mtime;
+    fs.size = st.st_size;
     fs.isdir = S_ISDIR(st.st_mode);
     return fs;
 }
 
 std::vector<long> sys_list_backups(const std::string &backup_name) {
-    fs::path p(backup_name);
-    std::string bname = p.filename().string();
-    fs::path dir = p.parent_path();
-    if (dir.empty())
-        dir = ".";
+    auto [dir, bname] = split_path(backup_name);
+
+    // The directory is only read if it has changed since we last looked,
+    // other than by our own creates, renames and unlinks.  The next backup
+    // goes after the last one, so that one must not have appeared unseen.
+    timespec mtime;
+    bool have_mtime = dir_mtime(dir, mtime);
+    if (have_mtime) {
+        auto it = backup_cache.find(dir);
+        if (it != backup_cache.end()) {
+            if (same_mtime(mtime, it->second.mtime)) {
+                auto found = it->second.versions.find(bname);
+                if (found != it->second.versions.end()) {
+                    const std::vector<long> &versions = found->second;
+                    long next = versions.empty() ? 1 : versions.back() + 1;
+                    if (!sys_file_exists(backup_name + std::to_string(next)))
+                        return versions;
+                    backup_cache.erase(it);
+                }
+            } else {
+                backup_cache.erase(it);
+            }
+        }
+    }
 
     std::vector<long> versions;
     std::error_code ec;
     for (auto const &de : fs::directory_iterator(dir, ec)) {
         if (ec)
             break;
-        std::string name = de.path().filename().string();
-        if (name.size() < bname.size())
-            continue;
-        if (name.compare(0, bname.size(), bname) != 0)
-            continue;
-
-        std::string_view suffix = std::string_view(name).substr(bname.size());
-        if (suffix.empty())
-            continue;
-
-        long v = 0;
-        auto res = std::from_chars(suffix.data(), suffix.data() + suffix.size(), v);
-        if (res.ptr != suffix.data() + suffix.size()) {
-            continue;
-        }
-        versions.push_back(v);
+        long v;
+        if (backup_version(de.path().filename().string(), bname, v))
+            versions.push_back(v);
     }
 
     std::sort(versions.begin(), versions.end());
+    if (have_mtime && !ec) {
+        backup_dir &cached = backup_cache[dir];
+        cached.mtime = mtime;
+        cached.versions[bname] = versions;
+    }
     return versions;
 }
@@ -24,9 +24,11 @@
 
 #include "text.h"
 
+#include "journal.h"
 #include "line.h"
 #include "mark.h"
 #include "screen.h"
+#include "undo.h"
 #include "var.h"
 #include "vdu.h"
 
@@ -116,6 +118,10 @@ bool text_insert(
                 return false;
             dst_line = dst_line->blink;
         }
+        if (!line_unshare(dst_line))
+            return false;
+        undo_line_change(dst_line);
+        journal_line_change(dst_line);
         // with dst_line^ do
         if (final_len > dst_line->len) {
             if (!line_change_length(dst_line, final_len)) {
@@ -208,6 +214,10 @@ bool text_overtype(
                 return false;
             dst_line = dst_line->blink;
         }
+        if (!line_unshare(dst_line))
+            return false;
+        undo_line_change(dst_line);
+        journal_line_change(dst_line);
         // with dst_line^ do
         if (final_len > dst_line->len) {
             if (!line_change_length(dst_line, final_len))
@@ -346,6 +356,10 @@ bool text_intra_remove(mark_ptr mark_one, strlen_range size) {
     strlen_range old_used = ln->used;
     if (col_one > old_used)
         return true;
+    if (!line_unshare(ln))
+        return false;
+    undo_line_change(ln);
+    journal_line_change(ln);
     strlen_range dst_len = old_used + 1 - col_one;
     if (col_two <= old_used)
         ln->str->fillcopy(*ln->str, col_two, old_used + 1 - col_two, col_one, dst_len, ' ');
@@ -584,7 +598,7 @@ bool text_inter_move(
     line_ptr next_src_line;
     line_ptr next_dst_line;
     line_ptr first_nicked;
-    line_ptr last_nicked;
+    line_ptr last_nicked = nullptr;
     line_range line_one_nr;
     line_range line_two_nr;
     line_range line_dst_nr;
@@ -597,6 +611,7 @@ bool text_inter_move(
     col_range dst_col;
     strlen_range dst_used;
     line_ptr dst_line;
+    bool move_nicked;
 
     bool result = false;
     line_ptr first_line = nullptr;
@@ -611,6 +626,11 @@ bool text_inter_move(
     if (!line_to_number(line_two, line_two_nr))
         goto l99;
 
+    // The interior lines of a transfer are moved straight to the destination,
+    // unless it is inside the area or on the null line.
+    move_nicked = !copy && (count == 1) && (line_two_nr - line_one_nr > 1) &&
+                  (dst->line->flink != nullptr);
+
     // Verify that the insertion will work.
 
     // Predict dst->col & dst->line->used just before
@@ -622,6 +642,7 @@ bool text_inter_move(
         if (!line_to_number(dst->line, line_dst_nr))
             goto l99;
         if ((line_one_nr <= line_dst_nr) && (line_dst_nr <= line_two_nr)) {
+            move_nicked = false;
             if ((line_two_nr == line_dst_nr) && (dst_col >= col_two)) {
                 // DST IS ON SAME LINE AS END, BUT BEYOND END
                 dst_col = col_one + dst_col - col_two;
@@ -679,21 +700,27 @@ bool text_inter_move(
                 last_nicked = line_two->blink;
                 if (!marks_squeeze(first_nicked, 1, last_nicked->flink, 1))
                     goto l99;
-                if (!lines_extract(first_nicked, last_nicked))
-                    goto l99;
+                if (move_nicked) {
+                    // Move them straight to the destination, a group at a time.
+                    if (!lines_move(first_nicked, last_nicked, dst->line->flink))
+                        goto l99;
+                } else {
+                    if (!lines_extract(first_nicked, last_nicked))
+                        goto l99;
 #ifdef DEBUG
-                if (next_dst_line->flink != nullptr) {
-                    screen_message(DBG_INTERNAL_LOGIC_ERROR);
-                    goto l99;
-                }
+                    if (next_dst_line->flink != nullptr) {
+                        screen_message(DBG_INTERNAL_LOGIC_ERROR);
+                        goto l99;
+                    }
 #endif
-                last_nicked->flink = next_dst_line;
-                first_nicked->blink = next_dst_line->blink;
-                if (first_nicked->blink != nullptr)
-                    first_nicked->blink->flink = first_nicked;
-                next_dst_line->blink = last_nicked;
-                if (next_dst_line == first_line)
-                    first_line = first_nicked;
+                    last_nicked->flink = next_dst_line;
+                    first_nicked->blink = next_dst_line->blink;
+                    if (first_nicked->blink != nullptr)
+                        first_nicked->blink->flink = first_nicked;
+                    next_dst_line->blink = last_nicked;
+                    if (next_dst_line == first_line)
+                        first_line = first_nicked;
+                }
                 next_src_line = line_two;
             }
         }
@@ -701,10 +728,8 @@ bool text_inter_move(
         // Copy remaining INTERIOR lines.
         while (next_src_line != line_two) {
             // with next_src_line^ do
-            if (!line_change_length(next_dst_line, next_src_line->used))
+            if (!line_share(next_dst_line, next_src_line))
                 goto l99;
-            next_dst_line->str->copy(*next_src_line->str, 1, next_src_line->used);
-            next_dst_line->used = next_src_line->used;
             next_src_line = next_src_line->flink;
             next_dst_line = next_dst_line->flink;
         }
@@ -807,11 +832,15 @@ bool text_inter_move(
         }
     }
 
-    if (!lines_inject(first_line, last_line, dst_line->flink))
+    if (!lines_inject(first_line, last_line, move_nicked ? last_nicked->flink : dst_line->flink))
         goto l99;
     if (!marks_shift(dst_line, dst_col, MAX_STRLENP + 1 - dst_col, last_line, col_two))
         goto l99;
     first_line = nullptr; // To prevent their destruction.
+    if (!line_unshare(dst_line))
+        goto l99;
+    undo_line_change(dst_line);
+    journal_line_change(dst_line);
     // with dst_line^ do
     if (text_len > 0) {
         if (!line_change_length(dst_line, dst_col + text_len - 1))
@@ -971,6 +1000,10 @@ bool text_split_line(mark_ptr before_mark, int new_col, mark_ptr &equals_mark) {
         if (length > 0) {
             if (!line_change_length(new_line, new_col + length - 1))
                 goto l99;
+            if (!line_unshare(before_mark->line))
+                goto l99;
+            undo_line_change(before_mark->line);
+            journal_line_change(before_mark->line);
             new_line->str->fill_n(' ', new_col - 1);
             new_line->str->copy(*before_mark->line->str, before_mark->col, length, new_col);
             before_mark->line->str->fill(' ', before_mark->col, before_mark->col + length - 1);
@@ -85,6 +85,8 @@ enum class frame_options_elts {
     opt_auto_indent,
     opt_auto_wrap,
     opt_new_line,
+    opt_adaptive_redraw,
+    opt_viewport,
     opt_special_frame, // OOPS,COMMAND,HEAP
     last_entry
 };
@@ -179,7 +181,7 @@ struct mark_object {
         allocated_marks -= 1;
     }
 
-    static size_t allocated_marks;
+    static thread_local size_t allocated_marks;
 };
 using mark_array = std::array<mark_ptr, MAX_MARK_NUMBER + 1>;
 
@@ -233,6 +235,8 @@ struct line_hdr_object {
     line_offset_range offset_nr;
     std::list<mark_ptr> marks;
     str_ptr str;
+    line_ptr str_flink; // Ring of lines sharing str, nil if not shared.
+    line_ptr str_blink;
     strlen_range len;
     strlen_range used;
     scr_row_range scr_row_nr;
@@ -597,6 +601,12 @@ struct file_data_type {
     std::string initial;
     bool purge;
     size_t versions;
+    size_t workers;                       // Parallel batch workers, 0 if not in use.
+    std::vector<std::string> batch_files; // Files for parallel batch processing.
+    std::string profile;                  // Interpreter profile report file.
+    bool stream;                          // Execute batch commands as they are read.
+    bool status_line;                     // Show a status line on the screen.
+    size_t window;                        // Input lines to keep read in below the dot, 0 for all.
 };
 
 struct code_object {
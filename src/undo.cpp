@@ -0,0 +1,315 @@
+/** @file undo.cpp
+ * Journal of the changes made to each frame, see undo.h.
+ */
+
+#include "undo.h"
+
+#include "journal.h"
+#include "line.h"
+#include "mark.h"
+#include "screen.h"
+#include "var.h"
+
+#include <algorithm>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+    enum class undo_kind { line_text, lines_added, lines_removed };
+
+    // One change.  Undoing it turns it into the change that redoes it.
+    struct undo_op {
+        undo_kind kind;
+        line_range line_nr;            // The changed line, or the first line added or removed.
+        line_range count;              // The number of lines added.
+        std::vector<std::string> text; // The old text of the line, or of the lines removed.
+    };
+
+    // The changes made to a frame by one command, and where its dot was.
+    struct undo_group {
+        line_range dot_line_nr;
+        col_range dot_col;
+        size_t space;
+        std::vector<undo_op> ops;
+    };
+
+    struct undo_journal {
+        std::deque<undo_group> done;
+        std::deque<undo_group> undone;
+        size_t space = 0;
+        unsigned long command = 0;               // The command done.back() belongs to.
+        bool lost = false;                       // The command's changes did not fit.
+        std::unordered_set<const_line_ptr> seen; // Lines whose old text done.back() has.
+    };
+
+    thread_local unsigned long command_nr = 0; // Nothing is recorded while zero.
+    thread_local bool replaying = false;
+    thread_local bool paused = false;
+    thread_local frame_ptr command_frame = nullptr;
+    thread_local line_range command_line_nr = 0;
+    thread_local col_range command_col = 1;
+    thread_local std::unordered_map<frame_ptr, undo_journal> journals;
+
+    std::string line_text(const_line_ptr line) {
+        if (line->used == 0)
+            return std::string();
+        return std::string(line->str->slice(1, line->used));
+    }
+
+    size_t op_space(const undo_op &op) {
+        size_t space = sizeof(undo_op);
+        for (const auto &text : op.text)
+            space += sizeof(std::string) + text.size();
+        return space;
+    }
+
+    size_t group_space(const undo_group &group) {
+        size_t space = sizeof(undo_group);
+        for (const auto &op : group.ops)
+            space += op_space(op);
+        return space;
+    }
+
+    // Return the journal to record a change to frame in, with a group open
+    // for the current command, or nullptr if the change is not recorded.
+    undo_journal *open_group(frame_ptr frame) {
+        // Frames being created or destroyed have no span.
+        if (command_nr == 0 || replaying || paused || frame->span == nullptr ||
+            frame->options.contains(frame_options_elts::opt_special_frame))
+            return nullptr;
+        undo_journal &j = journals[frame];
+        if (j.command != command_nr) {
+            j.command = command_nr;
+            j.lost = false;
+            j.seen.clear();
+            for (const auto &group : j.undone)
+                j.space -= group.space;
+            j.undone.clear();
+            undo_group group{command_line_nr, command_col, sizeof(undo_group), {}};
+            if (frame != command_frame) {
+                if (!line_to_number(frame->dot->line, group.dot_line_nr))
+                    return nullptr;
+                group.dot_col = frame->dot->col;
+            }
+            j.done.push_back(std::move(group));
+            j.space += j.done.back().space;
+        } else if (j.lost) {
+            return nullptr;
+        }
+        return &j;
+    }
+
+    // Add op to the open group, dropping the oldest groups to keep within
+    // the frame's space limit.
+    void record(frame_ptr frame, undo_journal &j, undo_op &&op) {
+        size_t space = op_space(op);
+        j.done.back().ops.push_back(std::move(op));
+        j.done.back().space += space;
+        j.space += space;
+        while (j.space > static_cast<size_t>(frame->space_limit) && j.done.size() > 1) {
+            j.space -= j.done.front().space;
+            j.done.pop_front();
+        }
+        if (j.space > static_cast<size_t>(frame->space_limit)) {
+            // The command alone is too big to undo.
+            j.done.clear();
+            j.space = 0;
+            j.seen.clear();
+            j.lost = true;
+        }
+    }
+
+    bool apply_op(frame_ptr frame, undo_op &op) {
+        line_ptr line;
+        if (!line_from_number(frame, op.line_nr, line) || line == nullptr)
+            return false;
+        switch (op.kind) {
+        case undo_kind::line_text: {
+            journal_line_change(line);
+            std::string text = line_text(line);
+            const std::string &old_text = op.text.front();
+            int old_used = old_text.size();
+            if (!line_unshare(line))
+                return false;
+            if (old_used > line->len && !line_change_length(line, old_used))
+                return false;
+            if (line->used > 0)
+                line->str->fill(' ', 1, line->used);
+            if (!old_text.empty())
+                line->str->copy_n(old_text.data(), old_used);
+            line->used = old_used;
+            op.text.front() = std::move(text);
+            if (line->scr_row_nr != 0)
+                screen_draw_line(line);
+            break;
+        }
+        case undo_kind::lines_added: {
+            std::vector<std::string> text;
+            text.reserve(op.count);
+            line_ptr last_line = line;
+            text.push_back(line_text(line));
+            for (line_range i = 2; i <= op.count; ++i) {
+                last_line = last_line->flink;
+                if (last_line == nullptr)
+                    return false;
+                text.push_back(line_text(last_line));
+            }
+            if (last_line->flink == nullptr)
+                return false;
+            if (!marks_squeeze(line, 1, last_line->flink, 1))
+                return false;
+            if (!lines_extract(line, last_line))
+                return false;
+            lines_destroy(line, last_line);
+            op.kind = undo_kind::lines_removed;
+            op.text = std::move(text);
+            break;
+        }
+        case undo_kind::lines_removed: {
+            line_ptr first_line;
+            line_ptr last_line;
+            if (!lines_create(op.text.size(), first_line, last_line))
+                return false;
+            line_ptr this_line = first_line;
+            for (const auto &text : op.text) {
+                if (!text.empty()) {
+                    if (!line_change_length(this_line, text.size())) {
+                        lines_destroy(first_line, last_line);
+                        return false;
+                    }
+                    this_line->str->copy_n(text.data(), text.size());
+                    this_line->used = text.size();
+                }
+                this_line = this_line->flink;
+            }
+            if (!lines_inject(first_line, last_line, line)) {
+                lines_destroy(first_line, last_line);
+                return false;
+            }
+            op.kind = undo_kind::lines_added;
+            op.count = op.text.size();
+            op.text.clear();
+            break;
+        }
+        }
+        return true;
+    }
+
+} // namespace
+
+void undo_begin_command() {
+    command_nr += 1;
+    command_frame = current_frame;
+    if (current_frame == nullptr || !line_to_number(current_frame->dot->line, command_line_nr))
+        command_frame = nullptr;
+    else
+        command_col = current_frame->dot->col;
+}
+
+void undo_initialize() {
+    command_nr = 0;
+    replaying = false;
+    paused = false;
+    command_frame = nullptr;
+    journals.clear();
+}
+
+void undo_discard(frame_ptr frame) {
+    journals.erase(frame);
+    if (command_frame == frame)
+        command_frame = nullptr;
+}
+
+void undo_pause(bool pause) {
+    paused = pause;
+}
+
+void undo_line_change(line_ptr line) {
+    // Lines not yet in a frame, and the null line, are not recorded.
+    if (line->group == nullptr || line->flink == nullptr)
+        return;
+    frame_ptr frame = line->group->frame;
+    undo_journal *j = open_group(frame);
+    if (j == nullptr || !j->seen.insert(line).second)
+        return;
+    line_range line_nr;
+    if (!line_to_number(line, line_nr))
+        return;
+    record(frame, *j, undo_op{undo_kind::line_text, line_nr, 1, {line_text(line)}});
+}
+
+void undo_lines_inject(line_range count, line_ptr before_line) {
+    frame_ptr frame = before_line->group->frame;
+    undo_journal *j = open_group(frame);
+    if (j == nullptr)
+        return;
+    line_range line_nr;
+    if (!line_to_number(before_line, line_nr))
+        return;
+    record(frame, *j, undo_op{undo_kind::lines_added, line_nr, count, {}});
+}
+
+void undo_lines_extract(line_ptr first_line, line_range count) {
+    frame_ptr frame = first_line->group->frame;
+    undo_journal *j = open_group(frame);
+    if (j == nullptr)
+        return;
+    line_range line_nr;
+    if (!line_to_number(first_line, line_nr))
+        return;
+    std::vector<std::string> text;
+    text.reserve(count);
+    for (const_line_ptr line = first_line; count > 0; line = line->flink, --count)
+        text.push_back(line_text(line));
+    record(frame, *j, undo_op{undo_kind::lines_removed, line_nr, 0, std::move(text)});
+}
+
+bool undo_apply(frame_ptr frame, bool redo, int count) {
+    auto it = journals.find(frame);
+    if (it == journals.end())
+        return false;
+    undo_journal &j = it->second;
+    std::deque<undo_group> &from = redo ? j.undone : j.done;
+    std::deque<undo_group> &to = redo ? j.done : j.undone;
+    if (count <= 0 || std::cmp_less(from.size(), count))
+        return false;
+
+    // Later changes start a new group.
+    j.command = 0;
+    j.seen.clear();
+    bool ok = true;
+    replaying = true;
+    for (int i = 1; ok && i <= count; ++i) {
+        undo_group group = std::move(from.back());
+        from.pop_back();
+        j.space -= group.space;
+        line_range dot_line_nr;
+        ok = line_to_number(frame->dot->line, dot_line_nr);
+        col_range dot_col = frame->dot->col;
+        for (auto op = group.ops.rbegin(); ok && op != group.ops.rend(); ++op)
+            ok = apply_op(frame, *op);
+        line_ptr line;
+        if (ok)
+            ok = line_from_number(frame, group.dot_line_nr, line) && line != nullptr &&
+                 mark_create(line, group.dot_col, frame->dot);
+        // Redoing the group runs the inverse changes in the opposite order.
+        std::reverse(group.ops.begin(), group.ops.end());
+        group.dot_line_nr = dot_line_nr;
+        group.dot_col = dot_col;
+        group.space = group_space(group);
+        j.space += group.space;
+        to.push_back(std::move(group));
+    }
+    replaying = false;
+    frame->text_modified = true;
+    if (ok)
+        ok = mark_create(frame->dot->line, frame->dot->col, frame->marks[MARK_MODIFIED]);
+    if (!ok)
+        journals.erase(it); // The journal no longer matches the frame.
+    return ok;
+}
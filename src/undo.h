@@ -0,0 +1,43 @@
+/** @file undo.h
+ * Journal of the changes made to each frame, so that they can be undone.
+ *
+ * The text and line primitives report each change before making it.  The
+ * journal keeps just enough to reverse it: the old text of a changed line,
+ * the text of removed lines, or the number of lines inserted.  Lines are
+ * identified by number, so nothing refers to lines that may be destroyed.
+ * The changes made by one command form a group, which is undone or redone
+ * as a whole.  The journal for a frame is limited to the frame's space
+ * limit, dropping the oldest groups first.
+ */
+
+#ifndef UNDO_H
+#define UNDO_H
+
+#include "type.h"
+
+// Start a new group of changes for each frame.  Nothing is recorded until
+// this has been called once.
+void undo_begin_command();
+
+// Forget everything, and stop recording until undo_begin_command.
+void undo_initialize();
+
+// Forget the changes made to a frame that is being destroyed.
+void undo_discard(frame_ptr frame);
+
+// Stop, or start again, recording changes.  Used for lines read ahead from
+// an input file, which are not changes to the text.
+void undo_pause(bool pause);
+
+// The text of the line is about to be changed.
+void undo_line_change(line_ptr line);
+// count lines are about to be injected before before_line.
+void undo_lines_inject(line_range count, line_ptr before_line);
+// count lines starting at first_line are about to be extracted from their frame.
+void undo_lines_extract(line_ptr first_line, line_range count);
+
+// Undo, or if redo redo, the last count groups of changes to the frame,
+// and move its dot to where it was.  Fails if there is nothing to undo.
+[[nodiscard]] bool undo_apply(frame_ptr frame, bool redo, int count);
+
+#endif // !defined(UNDO_H)
@@ -31,9 +31,12 @@
 #include "sys.h"
 #include "text.h"
 #include "tpar.h"
+#include "undo.h"
 #include "var.h"
 #include "vdu.h"
 
+#include <cstdlib>
+
 namespace {
     bool special_command(commands cmd) {
         return cmd == commands::cmd_verify || cmd == commands::cmd_exit_abort ||
@@ -226,7 +229,13 @@ bool user_subprocess() {
     return sys_shell();
 }
 
-bool user_undo() {
-    screen_message(MSG_NOT_IMPLEMENTED);
-    return false;
+bool user_undo(leadparam rept, int count) {
+    // UU undoes the last count commands' changes to the current frame, and
+    // -UU redoes them.
+    bool redo = (rept == leadparam::minus || rept == leadparam::nint);
+    if (!undo_apply(current_frame, redo, std::abs(count))) {
+        screen_message(redo ? MSG_NOTHING_TO_REDO : MSG_NOTHING_TO_UNDO);
+        return false;
+    }
+    return true;
 }
@@ -10,6 +10,6 @@ void user_key_initialize();
 [[nodiscard]] bool user_key(const tpar_object &key, const tpar_object &strng);
 [[nodiscard]] bool user_parent();
 [[nodiscard]] bool user_subprocess();
-[[nodiscard]] bool user_undo();
+[[nodiscard]] bool user_undo(leadparam rept, int count);
 
 #endif
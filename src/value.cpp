@@ -123,6 +123,12 @@ void setup_initial_values() {
     file_data.purge = false;
     file_data.versions = 1;
     file_data.initial.clear();
+    file_data.workers = 0;
+    file_data.batch_files.clear();
+    file_data.profile.clear();
+    file_data.stream = false;
+    file_data.status_line = false;
+    file_data.window = 0;
 
     word_elements[0] = SPACE_SET;
     /* word_elements[1]  = ALPHA_SET + NUMERIC_SET; */
@@ -835,7 +841,8 @@ void initialize_command_table_part2() {
          leadparam::pint,
          leadparam::nint,
          leadparam::pindef,
-         leadparam::nindef},
+         leadparam::nindef,
+         leadparam::marker},
         equalaction::eqnil,
         0,
         prompt_type::no_prompt,
@@ -853,7 +860,8 @@ void initialize_command_table_part2() {
          leadparam::pint,
          leadparam::nint,
          leadparam::pindef,
-         leadparam::nindef},
+         leadparam::nindef,
+         leadparam::marker},
         equalaction::eqnil,
         0,
         prompt_type::no_prompt,
@@ -871,7 +879,8 @@ void initialize_command_table_part2() {
          leadparam::pint,
          leadparam::nint,
          leadparam::pindef,
-         leadparam::nindef},
+         leadparam::nindef,
+         leadparam::marker},
         equalaction::eqnil,
         0,
         prompt_type::no_prompt,
@@ -1487,7 +1496,7 @@ void initialize_command_table_part2() {
     );
     init_cmd(
         commands::cmd_user_undo,
-        {leadparam::none},
+        {leadparam::none, leadparam::plus, leadparam::minus, leadparam::pint, leadparam::nint},
         equalaction::eqnil,
         0,
         prompt_type::no_prompt,
@@ -1920,52 +1929,53 @@ void load_command_table(bool old_version) {
         addlookupexp(44, 'K', commands::cmd_user_key);
         addlookupexp(45, 'P', commands::cmd_user_parent);
         addlookupexp(46, 'S', commands::cmd_user_subprocess);
-
-        // W prefix - window commands }  {47}
-        addlookupexp(47, 'F', commands::cmd_window_forward);
-        addlookupexp(48, 'B', commands::cmd_window_backward);
-        addlookupexp(49, 'M', commands::cmd_window_middle);
-        addlookupexp(50, 'T', commands::cmd_window_top);
-        addlookupexp(51, 'E', commands::cmd_window_end);
-        addlookupexp(52, 'N', commands::cmd_window_new);
-        addlookupexp(53, 'R', commands::cmd_window_right);
-        addlookupexp(54, 'L', commands::cmd_window_left);
-        addlookupexp(55, 'H', commands::cmd_window_setheight);
-        addlookupexp(56, 'S', commands::cmd_window_scroll);
-        addlookupexp(57, 'U', commands::cmd_window_update);
-
-        // X prefix - exit }             {58}
-        addlookupexp(58, 'S', commands::cmd_exit_success);
-        addlookupexp(59, 'F', commands::cmd_exit_fail);
-        addlookupexp(60, 'A', commands::cmd_exit_abort);
-
-        // Y prefix - word processing }  {61}
-        addlookupexp(61, 'F', commands::cmd_line_fill);
-        addlookupexp(62, 'J', commands::cmd_line_justify);
-        addlookupexp(63, 'S', commands::cmd_line_squash);
-        addlookupexp(64, 'C', commands::cmd_line_centre);
-        addlookupexp(65, 'L', commands::cmd_line_left);
-        addlookupexp(66, 'R', commands::cmd_line_right);
-        addlookupexp(67, 'A', commands::cmd_word_advance);
-        addlookupexp(68, 'D', commands::cmd_word_delete);
-
-        // Z prefix - cursor commands }  {69}
-        addlookupexp(69, 'U', commands::cmd_up);
-        addlookupexp(70, 'D', commands::cmd_down);
-        addlookupexp(71, 'R', commands::cmd_right);
-        addlookupexp(72, 'L', commands::cmd_left);
-        addlookupexp(73, 'H', commands::cmd_home);
-        addlookupexp(74, 'C', commands::cmd_return);
-        addlookupexp(75, 'T', commands::cmd_tab);
-        addlookupexp(76, 'B', commands::cmd_backtab);
-        addlookupexp(77, 'Z', commands::cmd_rubout);
-
-        // ~ prefix - miscellaneous debugging commands}  {78}
-        addlookupexp(78, 'V', commands::cmd_validate);
-        addlookupexp(79, 'D', commands::cmd_dump);
-
-        // sentinel }                    {80}
-        addlookupexp(80, '?', commands::cmd_nosuch);
+        addlookupexp(47, 'U', commands::cmd_user_undo);
+
+        // W prefix - window commands }  {48}
+        addlookupexp(48, 'F', commands::cmd_window_forward);
+        addlookupexp(49, 'B', commands::cmd_window_backward);
+        addlookupexp(50, 'M', commands::cmd_window_middle);
+        addlookupexp(51, 'T', commands::cmd_window_top);
+        addlookupexp(52, 'E', commands::cmd_window_end);
+        addlookupexp(53, 'N', commands::cmd_window_new);
+        addlookupexp(54, 'R', commands::cmd_window_right);
+        addlookupexp(55, 'L', commands::cmd_window_left);
+        addlookupexp(56, 'H', commands::cmd_window_setheight);
+        addlookupexp(57, 'S', commands::cmd_window_scroll);
+        addlookupexp(58, 'U', commands::cmd_window_update);
+
+        // X prefix - exit }             {59}
+        addlookupexp(59, 'S', commands::cmd_exit_success);
+        addlookupexp(60, 'F', commands::cmd_exit_fail);
+        addlookupexp(61, 'A', commands::cmd_exit_abort);
+
+        // Y prefix - word processing }  {62}
+        addlookupexp(62, 'F', commands::cmd_line_fill);
+        addlookupexp(63, 'J', commands::cmd_line_justify);
+        addlookupexp(64, 'S', commands::cmd_line_squash);
+        addlookupexp(65, 'C', commands::cmd_line_centre);
+        addlookupexp(66, 'L', commands::cmd_line_left);
+        addlookupexp(67, 'R', commands::cmd_line_right);
+        addlookupexp(68, 'A', commands::cmd_word_advance);
+        addlookupexp(69, 'D', commands::cmd_word_delete);
+
+        // Z prefix - cursor commands }  {70}
+        addlookupexp(70, 'U', commands::cmd_up);
+        addlookupexp(71, 'D', commands::cmd_down);
+        addlookupexp(72, 'R', commands::cmd_right);
+        addlookupexp(73, 'L', commands::cmd_left);
+        addlookupexp(74, 'H', commands::cmd_home);
+        addlookupexp(75, 'C', commands::cmd_return);
+        addlookupexp(76, 'T', commands::cmd_tab);
+        addlookupexp(77, 'B', commands::cmd_backtab);
+        addlookupexp(78, 'Z', commands::cmd_rubout);
+
+        // ~ prefix - miscellaneous debugging commands}  {79}
+        addlookupexp(79, 'V', commands::cmd_validate);
+        addlookupexp(80, 'D', commands::cmd_dump);
+
+        // sentinel }                    {81}
+        addlookupexp(81, '?', commands::cmd_nosuch);
 
         // initialize lookupexp_ptr }
         // These magic numbers point to the start/end of each section in lookupexp table }
@@ -1989,13 +1999,13 @@ void load_command_table(bool old_version) {
         lookupexp_ptr[commands::cmd_prefix_t] = {43, 43};
         lookupexp_ptr[commands::cmd_prefix_tc] = {43, 43};
         lookupexp_ptr[commands::cmd_prefix_tf] = {43, 43};
-        lookupexp_ptr[commands::cmd_prefix_u] = {43, 47};
-        lookupexp_ptr[commands::cmd_prefix_w] = {47, 58};
-        lookupexp_ptr[commands::cmd_prefix_x] = {58, 61};
-        lookupexp_ptr[commands::cmd_prefix_y] = {61, 69};
-        lookupexp_ptr[commands::cmd_prefix_z] = {69, 78};
-        lookupexp_ptr[commands::cmd_prefix_tilde] = {78, 80};
-        lookupexp_ptr[commands::cmd_nosuch] = {80, 81};
+        lookupexp_ptr[commands::cmd_prefix_u] = {43, 48};
+        lookupexp_ptr[commands::cmd_prefix_w] = {48, 59};
+        lookupexp_ptr[commands::cmd_prefix_x] = {59, 62};
+        lookupexp_ptr[commands::cmd_prefix_y] = {62, 70};
+        lookupexp_ptr[commands::cmd_prefix_z] = {70, 79};
+        lookupexp_ptr[commands::cmd_prefix_tilde] = {79, 81};
+        lookupexp_ptr[commands::cmd_nosuch] = {81, 82};
     } else {
         lookup[0].command = commands::cmd_noop;
         lookup[1].command = commands::cmd_noop;
@@ -2245,39 +2255,40 @@ void load_command_table(bool old_version) {
 
         // U prefix - user keyboard mappings }   {97}
         addlookupexp(97, 'C', commands::cmd_user_command_introducer);
-
-        // W prefix - window commands }  {98}
-        addlookupexp(98, 'B', commands::cmd_window_backward);
-        addlookupexp(99, 'C', commands::cmd_window_middle);
-        addlookupexp(100, 'E', commands::cmd_window_end);
-        addlookupexp(101, 'F', commands::cmd_window_forward);
-        addlookupexp(102, 'H', commands::cmd_window_setheight);
-        addlookupexp(103, 'L', commands::cmd_window_left);
-        addlookupexp(104, 'M', commands::cmd_window_scroll);
-        addlookupexp(105, 'N', commands::cmd_window_new);
-        addlookupexp(106, 'O', commands::cmd_noop);
-        addlookupexp(107, 'R', commands::cmd_window_right);
-        addlookupexp(108, 'S', commands::cmd_noop);
-        addlookupexp(109, 'T', commands::cmd_window_top);
-        addlookupexp(110, 'U', commands::cmd_window_update);
-
-        // X prefix - exit }             {111}
-        addlookupexp(111, 'A', commands::cmd_exit_abort);
-        addlookupexp(112, 'F', commands::cmd_exit_fail);
-        addlookupexp(113, 'S', commands::cmd_exit_success);
-
-        // Y prefix }        {114}
+        addlookupexp(98, 'U', commands::cmd_user_undo);
+
+        // W prefix - window commands }  {99}
+        addlookupexp(99, 'B', commands::cmd_window_backward);
+        addlookupexp(100, 'C', commands::cmd_window_middle);
+        addlookupexp(101, 'E', commands::cmd_window_end);
+        addlookupexp(102, 'F', commands::cmd_window_forward);
+        addlookupexp(103, 'H', commands::cmd_window_setheight);
+        addlookupexp(104, 'L', commands::cmd_window_left);
+        addlookupexp(105, 'M', commands::cmd_window_scroll);
+        addlookupexp(106, 'N', commands::cmd_window_new);
+        addlookupexp(107, 'O', commands::cmd_noop);
+        addlookupexp(108, 'R', commands::cmd_window_right);
+        addlookupexp(109, 'S', commands::cmd_noop);
+        addlookupexp(110, 'T', commands::cmd_window_top);
+        addlookupexp(111, 'U', commands::cmd_window_update);
+
+        // X prefix - exit }             {112}
+        addlookupexp(112, 'A', commands::cmd_exit_abort);
+        addlookupexp(113, 'F', commands::cmd_exit_fail);
+        addlookupexp(114, 'S', commands::cmd_exit_success);
+
+        // Y prefix }        {115}
         // There aren't any in this table! }
 
-        // Z prefix }        {114}
+        // Z prefix }        {115}
         // There aren't any in this table! }
 
-        // ~ prefix - miscellaneous debugging commands}  {114}
-        addlookupexp(114, 'D', commands::cmd_dump);
-        addlookupexp(115, 'V', commands::cmd_validate);
+        // ~ prefix - miscellaneous debugging commands}  {115}
+        addlookupexp(115, 'D', commands::cmd_dump);
+        addlookupexp(116, 'V', commands::cmd_validate);
 
-        // sentinel }                    {116}
-        addlookupexp(116, '?', commands::cmd_nosuch);
+        // sentinel }                    {117}
+        addlookupexp(117, '?', commands::cmd_nosuch);
 
         // initialize lookupexp_ptr }
         // These magic numbers point to the start/end of each section in lookupexp table }
@@ -2301,13 +2312,13 @@ void load_command_table(bool old_version) {
         lookupexp_ptr[commands::cmd_prefix_t] = {79, 88};
         lookupexp_ptr[commands::cmd_prefix_tc] = {88, 91};
         lookupexp_ptr[commands::cmd_prefix_tf] = {91, 97};
-        lookupexp_ptr[commands::cmd_prefix_u] = {97, 98};
-        lookupexp_ptr[commands::cmd_prefix_w] = {98, 111};
-        lookupexp_ptr[commands::cmd_prefix_x] = {111, 114};
-        lookupexp_ptr[commands::cmd_prefix_y] = {114, 114};
-        lookupexp_ptr[commands::cmd_prefix_z] = {114, 114};
-        lookupexp_ptr[commands::cmd_prefix_tilde] = {114, 116};
-        lookupexp_ptr[commands::cmd_nosuch] = {116, 117};
+        lookupexp_ptr[commands::cmd_prefix_u] = {97, 99};
+        lookupexp_ptr[commands::cmd_prefix_w] = {99, 112};
+        lookupexp_ptr[commands::cmd_prefix_x] = {112, 115};
+        lookupexp_ptr[commands::cmd_prefix_y] = {115, 115};
+        lookupexp_ptr[commands::cmd_prefix_z] = {115, 115};
+        lookupexp_ptr[commands::cmd_prefix_tilde] = {115, 117};
+        lookupexp_ptr[commands::cmd_nosuch] = {117, 118};
     }
 }
 
@@ -7,73 +7,73 @@
 const std::string ludwig_version("X5.0-006");
 std::string program_directory; // Used to determine program startup directory.
 // FIXME: terminal_capabilities tt_capabilities;   // H/W abilities of terminal.
-bool tt_controlc;   // User has typed CNTRL/C.
-bool tt_winchanged; // Window size has changed
+thread_local bool tt_controlc;   // User has typed CNTRL/C.
+thread_local bool tt_winchanged; // Window size has changed
 
 // Keyboard interface.
-key_names_range nr_key_names;
-std::vector<key_name_record> key_name_list;
-accept_set_type key_introducers;
+thread_local key_names_range nr_key_names;
+thread_local std::vector<key_name_record> key_name_list;
+thread_local accept_set_type key_introducers;
 
 // SPECIAL FRAMES.
-frame_ptr current_frame; // Compiler/Interpreter use as focal frame.
-frame_ptr frame_oops;    // Pointer to frame OOPS.
-frame_ptr frame_cmd;     // Pointer to frame COMMAND.
-frame_ptr frame_heap;    // pointer to frame HEAP.
+thread_local frame_ptr current_frame; // Compiler/Interpreter use as focal frame.
+thread_local frame_ptr frame_oops;    // Pointer to frame OOPS.
+thread_local frame_ptr frame_cmd;     // Pointer to frame COMMAND.
+thread_local frame_ptr frame_heap;    // pointer to frame HEAP.
 
 // GLOBAL VARIABLES.
-bool ludwig_aborted; // Something terrible has happened....
-bool exit_abort;     // Set for doing XA commands.
-bool vdu_free_flag;  // Set if vdu_free has been called already
-bool hangup;         // Ludwig has received a hangup signal.
+thread_local bool ludwig_aborted; // Something terrible has happened....
+thread_local bool exit_abort;     // Set for doing XA commands.
+thread_local bool vdu_free_flag;  // Set if vdu_free has been called already
+thread_local bool hangup;         // Ludwig has received a hangup signal.
 
-mode_type edit_mode; // User selectable editing mode.
-mode_type previous_mode;
+thread_local mode_type edit_mode; // User selectable editing mode.
+thread_local mode_type previous_mode;
 
-std::array<file_ptr, MAX_FILES> files; // I/O file pointers.
-std::array<frame_ptr, MAX_FILES> files_frames;
+thread_local std::array<file_ptr, MAX_FILES> files; // I/O file pointers.
+thread_local std::array<frame_ptr, MAX_FILES> files_frames;
 
-slot_range fgi_file;
-slot_range fgo_file;
+thread_local slot_range fgi_file;
+thread_local slot_range fgo_file;
 
-span_ptr first_span; // Pointer to first in the list of spans.
+thread_local span_ptr first_span; // Pointer to first in the list of spans.
 
-ludwig_mode_type ludwig_mode;
-key_code_range command_introducer; // Key used to prefix immediate commands.
+thread_local ludwig_mode_type ludwig_mode;
+thread_local key_code_range command_introducer; // Key used to prefix immediate commands.
 
-std::array<prompt_region_attrib, MAX_TPCOUNT + 1> prompt_region;
+thread_local std::array<prompt_region_attrib, MAX_TPCOUNT + 1> prompt_region;
 
-frame_ptr scr_frame;       // Frame that screen currently mapped into.
-line_ptr scr_top_line;     // Pointer to first line mapped on screen.
-line_ptr scr_bot_line;     // Pointer to last line mapped on screen.
-scr_row_range scr_msg_row; // First (highest) msg on scr, 0 if none.
-bool scr_needs_fix;        // Set when user is viewing a corrupt screen.
+thread_local frame_ptr scr_frame;       // Frame that screen currently mapped into.
+thread_local line_ptr scr_top_line;     // Pointer to first line mapped on screen.
+thread_local line_ptr scr_bot_line;     // Pointer to last line mapped on screen.
+thread_local scr_row_range scr_msg_row; // First (highest) msg on scr, 0 if none.
+thread_local bool scr_needs_fix;        // Set when user is viewing a corrupt screen.
 
 // COMPILER VARIABLES.
-std::array<code_object, MAX_CODE> compiler_code;
-code_ptr code_list;
-code_idx code_top;
+thread_local std::array<code_object, MAX_CODE> compiler_code;
+thread_local code_ptr code_list;
+thread_local code_idx code_top;
 
 // VARIABLES USED IN INTERPRETING A COMMAND
-std::unordered_set<commands> prefixes;
-std::array<command_object, LOOKUP_SIZE> lookup;
-std::array<lookupexp_type, EXPAND_LIM> lookupexp;
-std::unordered_map<commands, std::pair<int, int>> lookupexp_ptr;
-std::unordered_map<commands, cmd_attrib_rec> cmd_attrib;
-std::unordered_map<prompt_type, std::string_view> dflt_prompts;
-prange<0, MAX_EXEC_RECURSION> exec_level;
+thread_local std::unordered_set<commands> prefixes;
+thread_local std::array<command_object, LOOKUP_SIZE> lookup;
+thread_local std::array<lookupexp_type, EXPAND_LIM> lookupexp;
+thread_local std::unordered_map<commands, std::pair<int, int>> lookupexp_ptr;
+thread_local std::unordered_map<commands, cmd_attrib_rec> cmd_attrib;
+thread_local std::unordered_map<prompt_type, std::string_view> dflt_prompts;
+thread_local prange<0, MAX_EXEC_RECURSION> exec_level;
 
 // INITIAL FRAME SETTINGS.
-mark_array initial_marks;
-scr_row_range initial_scr_height;
-scr_col_range initial_scr_width;
-col_offset_range initial_scr_offset;
-col_range initial_margin_left;
-col_range initial_margin_right;
-scr_row_range initial_margin_top;
-scr_row_range initial_margin_bottom;
-tab_array initial_tab_stops;
-frame_options initial_options;
+thread_local mark_array initial_marks;
+thread_local scr_row_range initial_scr_height;
+thread_local scr_col_range initial_scr_width;
+thread_local col_offset_range initial_scr_offset;
+thread_local col_range initial_margin_left;
+thread_local col_range initial_margin_right;
+thread_local scr_row_range initial_margin_top;
+thread_local scr_row_range initial_margin_bottom;
+thread_local tab_array initial_tab_stops;
+thread_local frame_options initial_options;
 
 // USEFUL STUFF.
 // Helper function to create default tab stops (every 8 columns starting at 1)
@@ -89,17 +89,17 @@ const str_object BLANK_STRING(' ');       // Blank chars only
 const tab_array DEFAULT_TAB_STOPS = make_default_tab_stops();
 
 // STRUCTURE POOLS
-group_ptr free_group_pool;
-line_ptr free_line_pool;
+thread_local group_ptr free_group_pool;
+thread_local line_ptr free_line_pool;
 
 // Output file actions
-file_data_type file_data;
+thread_local file_data_type file_data;
 
 // Info about the terminal
-terminal_info_type terminal_info;
+thread_local terminal_info_type terminal_info;
 
 // Word definition sets
-std::array<accept_set_type, MAX_WORD_SETS> word_elements;
+thread_local std::array<accept_set_type, MAX_WORD_SETS> word_elements;
 
 // Pattern matcher parser stuff
 
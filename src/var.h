@@ -1,5 +1,8 @@
 /** @file var.h
  * Declarations of variables used throughout the Ludwig code base.
+ *
+ * The editor state is thread local, so each thread hosts its own
+ * independent editing session.  See session.h.
  */
 
 #ifndef VAR_H
@@ -8,61 +11,61 @@
 #include "type.h"
 
 extern const std::string ludwig_version;
-extern std::string program_directory; // Used to determine program startup directory.
-extern bool tt_controlc;              // User has typed CNTRL/C.
-extern bool tt_winchanged;            // Window size has changed
+extern std::string program_directory;   // Used to determine program startup directory.
+extern thread_local bool tt_controlc;   // User has typed CNTRL/C.
+extern thread_local bool tt_winchanged; // Window size has changed
 
 // Keyboard interface.
-extern key_names_range nr_key_names;
-extern std::vector<key_name_record> key_name_list;
-extern accept_set_type key_introducers;
+extern thread_local key_names_range nr_key_names;
+extern thread_local std::vector<key_name_record> key_name_list;
+extern thread_local accept_set_type key_introducers;
 
 // SPECIAL FRAMES.
-extern frame_ptr current_frame; // Compiler/Interpreter use as focal frame.
-extern frame_ptr frame_oops;    // Pointer to frame OOPS.
-extern frame_ptr frame_cmd;     // Pointer to frame COMMAND.
-extern frame_ptr frame_heap;    // pointer to frame HEAP.
+extern thread_local frame_ptr current_frame; // Compiler/Interpreter use as focal frame.
+extern thread_local frame_ptr frame_oops;    // Pointer to frame OOPS.
+extern thread_local frame_ptr frame_cmd;     // Pointer to frame COMMAND.
+extern thread_local frame_ptr frame_heap;    // pointer to frame HEAP.
 
 // GLOBAL VARIABLES.
-extern bool ludwig_aborted; // Something terrible has happened....
-extern bool exit_abort;     // Set for doing XA commands.
-extern bool vdu_free_flag;  // Set if vdu_free has been called already
-extern bool hangup;         // Ludwig has received a hangup signal.
+extern thread_local bool ludwig_aborted; // Something terrible has happened....
+extern thread_local bool exit_abort;     // Set for doing XA commands.
+extern thread_local bool vdu_free_flag;  // Set if vdu_free has been called already
+extern thread_local bool hangup;         // Ludwig has received a hangup signal.
 
 enum class mode_type { mode_overtype, mode_insert, mode_command };
 
-extern mode_type edit_mode; // User selectable editing mode.
-extern mode_type previous_mode;
+extern thread_local mode_type edit_mode; // User selectable editing mode.
+extern thread_local mode_type previous_mode;
 
-extern std::array<file_ptr, MAX_FILES> files; // I/O file pointers.
-extern std::array<frame_ptr, MAX_FILES> files_frames;
+extern thread_local std::array<file_ptr, MAX_FILES> files; // I/O file pointers.
+extern thread_local std::array<frame_ptr, MAX_FILES> files_frames;
 
-extern slot_range fgi_file;
-extern slot_range fgo_file;
+extern thread_local slot_range fgi_file;
+extern thread_local slot_range fgo_file;
 
-extern span_ptr first_span; // Pointer to first in the list of spans.
+extern thread_local span_ptr first_span; // Pointer to first in the list of spans.
 
 enum class ludwig_mode_type { ludwig_batch, ludwig_hardcopy, ludwig_screen };
 
-extern ludwig_mode_type ludwig_mode;
-extern key_code_range command_introducer; // Key used to prefix immediate commands.
+extern thread_local ludwig_mode_type ludwig_mode;
+extern thread_local key_code_range command_introducer; // Key used to prefix immediate commands.
 
-extern std::array<prompt_region_attrib, MAX_TPCOUNT + 1> prompt_region;
+extern thread_local std::array<prompt_region_attrib, MAX_TPCOUNT + 1> prompt_region;
 
-extern frame_ptr scr_frame;       // Frame that screen currently mapped into.
-extern line_ptr scr_top_line;     // Pointer to first line mapped on screen.
-extern line_ptr scr_bot_line;     // Pointer to last line mapped on screen.
-extern scr_row_range scr_msg_row; // First (highest) msg on scr, 0 if none.
-extern bool scr_needs_fix;        // Set when user is viewing a corrupt screen.
+extern thread_local frame_ptr scr_frame;       // Frame that screen currently mapped into.
+extern thread_local line_ptr scr_top_line;     // Pointer to first line mapped on screen.
+extern thread_local line_ptr scr_bot_line;     // Pointer to last line mapped on screen.
+extern thread_local scr_row_range scr_msg_row; // First (highest) msg on scr, 0 if none.
+extern thread_local bool scr_needs_fix;        // Set when user is viewing a corrupt screen.
 
 // COMPILER VARIABLES.
-extern std::array<code_object, MAX_CODE> compiler_code;
-extern code_ptr code_list;
-extern code_idx code_top;
+extern thread_local std::array<code_object, MAX_CODE> compiler_code;
+extern thread_local code_ptr code_list;
+extern thread_local code_idx code_top;
 
 // VARIABLES USED IN INTERPRETING A COMMAND
-extern std::unordered_set<commands> prefixes;
-extern std::array<command_object, LOOKUP_SIZE> lookup;
+extern thread_local std::unordered_set<commands> prefixes;
+extern thread_local std::array<command_object, LOOKUP_SIZE> lookup;
 
 // Helper to convert key code to lookup array index
 // Keys 0..ORD_MAXCHAR stay at indices 0..255
@@ -77,31 +80,31 @@ struct lookupexp_type {
 };
 using expand_lim_range = prange<0, EXPAND_LIM - 1>;
 
-extern std::array<lookupexp_type, EXPAND_LIM> lookupexp;
-extern std::unordered_map<commands, std::pair<int, int>> lookupexp_ptr;
-extern std::unordered_map<commands, cmd_attrib_rec> cmd_attrib;
-extern std::unordered_map<prompt_type, std::string_view> dflt_prompts;
-extern prange<0, MAX_EXEC_RECURSION> exec_level;
+extern thread_local std::array<lookupexp_type, EXPAND_LIM> lookupexp;
+extern thread_local std::unordered_map<commands, std::pair<int, int>> lookupexp_ptr;
+extern thread_local std::unordered_map<commands, cmd_attrib_rec> cmd_attrib;
+extern thread_local std::unordered_map<prompt_type, std::string_view> dflt_prompts;
+extern thread_local prange<0, MAX_EXEC_RECURSION> exec_level;
 
 // INITIAL FRAME SETTINGS.
-extern mark_array initial_marks;
-extern scr_row_range initial_scr_height;
-extern scr_col_range initial_scr_width;
-extern col_offset_range initial_scr_offset;
-extern col_range initial_margin_left;
-extern col_range initial_margin_right;
-extern scr_row_range initial_margin_top;
-extern scr_row_range initial_margin_bottom;
-extern tab_array initial_tab_stops;
-extern frame_options initial_options;
+extern thread_local mark_array initial_marks;
+extern thread_local scr_row_range initial_scr_height;
+extern thread_local scr_col_range initial_scr_width;
+extern thread_local col_offset_range initial_scr_offset;
+extern thread_local col_range initial_margin_left;
+extern thread_local col_range initial_margin_right;
+extern thread_local scr_row_range initial_margin_top;
+extern thread_local scr_row_range initial_margin_bottom;
+extern thread_local tab_array initial_tab_stops;
+extern thread_local frame_options initial_options;
 
 // USEFUL STUFF.
 extern const str_object BLANK_STRING;
 extern const tab_array DEFAULT_TAB_STOPS;
 
 // STRUCTURE POOLS
-extern group_ptr free_group_pool;
-extern line_ptr free_line_pool;
+extern thread_local group_ptr free_group_pool;
+extern thread_local line_ptr free_line_pool;
 
 // Sets of characters
 // Pattern matcher parser stuff
@@ -114,12 +117,12 @@ extern const accept_set_type NUMERIC_SET;
 extern const accept_set_type PUNCTUATION_SET;
 
 // Output file actions
-extern file_data_type file_data;
+extern thread_local file_data_type file_data;
 
 // Info about the terminal
-extern terminal_info_type terminal_info;
+extern thread_local terminal_info_type terminal_info;
 
 // Word definition sets
-extern std::array<accept_set_type, MAX_WORD_SETS> word_elements;
+extern thread_local std::array<accept_set_type, MAX_WORD_SETS> word_elements;
 
 #endif // !defined(VAR_H)
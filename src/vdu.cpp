@@ -24,8 +24,10 @@
 #include "vdu.h"
 
 #include "sys.h"
+#include "vdu_backend.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cstring>
 #include <ncurses.h>
 #include <unordered_set>
@@ -61,6 +63,30 @@ namespace {
     std::unordered_set<int> terminators;
     bool vdu_setup = false;
     bool in_insert_mode = false;
+    WINDOW *peek_win = nullptr; // Never written, so reading from it never refreshes.
+    WINDOW *status_win = nullptr;
+    bool status_line = false;
+
+    int init_status_win(WINDOW *win, int) {
+        // Called by initscr for the line taken off the bottom of the screen.
+        status_win = win;
+        ::leaveok(win, true);
+        return OK;
+    }
+
+    // Output is accumulated in the curses window and only sent to the
+    // terminal when vdu_flush is called, normally when waiting for input.
+    bool output_pending = false;
+    unsigned long refresh_count = 0;
+
+    // How long the last update of the terminal took and when it finished.
+    // Writing to a slow terminal blocks once the buffers on the way to it
+    // are full, so this follows the speed of the link.
+    std::chrono::steady_clock::duration last_update_time{};
+    std::chrono::steady_clock::time_point last_update_end{};
+    // An adaptive progress update is skipped until the terminal has been
+    // left alone for this many times as long as the last update took.
+    const int ADAPTIVE_REST_RATIO = 2;
 
     template <typename T> bool contains(const std::unordered_set<T> &s, const T &value) {
         return s.find(value) != s.end();
@@ -88,24 +114,217 @@ namespace {
             return NCURSES_SUBTRACT - int(key);
         return 0;
     }
+
+    class curses_backend : public vdu_backend {
+    public:
+        int width() const override {
+            return ::COLS;
+        }
+        int height() const override {
+            return ::LINES;
+        }
+        int cursor_col() const override {
+            return getcurx(stdscr) + 1;
+        }
+        int cursor_row() const override {
+            return getcury(stdscr) + 1;
+        }
+
+        void move_cursor(int col, int row) override {
+            ::move(row - 1, col - 1);
+        }
+        void put(std::string_view str) override {
+            ::addnstr(str.data(), int(str.size()));
+        }
+        void bold(bool on) override {
+            if (on) {
+                attron(A_BOLD);
+            } else {
+                attroff(A_BOLD);
+                attroff(A_REVERSE);
+            }
+        }
+        void clear_eol() override {
+            ::clrtoeol();
+        }
+        void clear_eos() override {
+            if (region_bottom() == ::LINES) {
+                ::clrtobot();
+                return;
+            }
+            int row = getcury(stdscr);
+            int col = getcurx(stdscr);
+            ::clrtoeol();
+            for (int r = row + 1; r < region_bottom(); ++r) {
+                ::move(r, 0);
+                ::clrtoeol();
+            }
+            ::move(row, col);
+        }
+        void clear_screen() override {
+            if (region_bottom() == ::LINES) {
+                ::clear();
+                return;
+            }
+            for (int r = 0; r < region_bottom(); ++r) {
+                ::move(r, 0);
+                ::clrtoeol();
+            }
+            ::move(0, 0);
+            ::clearok(stdscr, true); // Repaint it all, as clear would.
+        }
+        void scroll_up(int n) override {
+            scroll_region(0, n);
+        }
+        void insert_lines(int n) override {
+            if (region_bottom() == ::LINES)
+                ::insdelln(n);
+            else if (getcury(stdscr) < region_bottom())
+                scroll_region(getcury(stdscr), -n);
+        }
+        void delete_lines(int n) override {
+            if (region_bottom() == ::LINES)
+                ::insdelln(-n);
+            else if (getcury(stdscr) < region_bottom())
+                scroll_region(getcury(stdscr), n);
+        }
+        void insert_chars(int n) override {
+            for (int i = 0; i < n; ++i)
+                ::insch(chtype(' '));
+        }
+        void delete_chars(int n) override {
+            for (int i = 0; i < n; ++i)
+                ::delch();
+        }
+        void beep() override {
+            if (ERR == ::flash())
+                ::beep();
+        }
+        void reserve_status_line() override {
+            ::ripoffline(-1, init_status_win);
+        }
+        void put_status(std::string_view str) override {
+            if (status_win == nullptr)
+                return;
+            ::werase(status_win);
+            wattron(status_win, A_REVERSE);
+            mvwaddnstr(status_win, 0, 0, str.data(), std::min(int(str.size()), ::COLS - 1));
+            wattroff(status_win, A_REVERSE);
+            ::wnoutrefresh(status_win);
+        }
+        void set_region(int bottom) override {
+            region = bottom;
+        }
+        void update() override {
+            ::refresh();
+        }
+
+        key_code_range get_key() override {
+            int raw_key;
+            do {
+                raw_key = ::getch();
+            } while (raw_key == ERR);
+            if (raw_key == KEY_RESIZE && g_winchange)
+                *g_winchange = true;
+            return massage_key(raw_key);
+        }
+        bool key_pending(key_code_range &key) override {
+            // Read through a window that is never written to, so that the
+            // read doesn't refresh the screen.
+            if (peek_win == nullptr)
+                return false;
+            int raw_key = ::wgetch(peek_win);
+            if (raw_key == ERR)
+                return false;
+            ::ungetch(raw_key);
+            key = massage_key(raw_key);
+            return true;
+        }
+        void take_back_key(key_code_range key) override {
+            ::ungetch(unmassage_key(key));
+        }
+
+        void new_dimensions(int &width, int &height) override {
+            // Curses has already resized its windows by the time it returns
+            // KEY_RESIZE, and repaints them at the next refresh.
+            region = 0;
+            width = ::COLS;
+            height = ::LINES;
+        }
+
+    private:
+        int region = 0; // Bottom row of the region, 0 for the whole screen.
+
+        int region_bottom() const {
+            return (region > 0 && region < ::LINES) ? region : ::LINES;
+        }
+
+        void scroll_region(int top, int n) {
+            // Scroll rows top..region_bottom up n rows, or down if n is -ve.
+            int row = getcury(stdscr);
+            int col = getcurx(stdscr);
+            ::setscrreg(top, region_bottom() - 1);
+            ::scrollok(stdscr, true);
+            ::scrl(n);
+            ::scrollok(stdscr, false);
+            ::setscrreg(0, ::LINES - 1);
+            ::move(row, col);
+        }
+    };
+
+    curses_backend curses;
+    vdu_backend *backend = nullptr;
 } // namespace
 
 void vdu_movecurs(scr_col_range x, scr_row_range y) {
-    ::move(y - 1, x - 1);
+    backend->move_cursor(x, y);
+    output_pending = true;
 }
 
 void vdu_flush() {
-    ::refresh();
+    if (output_pending) {
+        auto start = std::chrono::steady_clock::now();
+        backend->update();
+        last_update_end = std::chrono::steady_clock::now();
+        last_update_time = last_update_end - start;
+        output_pending = false;
+        refresh_count += 1;
+    }
+}
+
+void vdu_flush_progress(bool adaptive) {
+    if (adaptive &&
+        std::chrono::steady_clock::now() - last_update_end < last_update_time * ADAPTIVE_REST_RATIO)
+        return; // The terminal is still catching up, show a later state.
+    vdu_flush();
+}
+
+unsigned long vdu_refresh_count() {
+    return refresh_count;
 }
 
 void vdu_beep() {
-    if (ERR == flash())
-        beep();
+    backend->beep();
+}
+
+void vdu_reserve_status_line() {
+    status_line = true;
+}
+
+void vdu_set_region(scr_row_range bottom) {
+    backend->set_region(bottom);
+}
+
+void vdu_display_status(std::string_view str) {
+    if (status_line) {
+        backend->put_status(str);
+        output_pending = true;
+    }
 }
 
 void vdu_cleareol() {
-    ::clrtoeol();
-    vdu_flush();
+    backend->clear_eol();
+    output_pending = true;
 }
 
 void vdu_displaystr(std::string_view str, int opts) {
@@ -114,73 +333,70 @@ void vdu_displaystr(std::string_view str, int opts) {
 
 void vdu_displaystr(scr_col_range strlen, const char *str, int opts) {
     int slen = int(strlen);
-    int maxlen = ::COLS - getcurx(stdscr);
+    int maxlen = backend->width() - backend->cursor_col() + 1;
     bool hitmargin;
     if (slen >= maxlen) {
         slen = maxlen;
         hitmargin = true;
     } else
         hitmargin = false;
-    ::addnstr(str, slen);
+    backend->put(std::string_view(str, std::max(slen, 0)));
     if (!hitmargin && (opts & OUT_M_CLEAREOL) != 0)
         vdu_cleareol();
-    vdu_flush();
+    output_pending = true;
 }
 
 void vdu_displaych(char ch) {
-    ::addch(chtype(ch));
+    backend->put(std::string_view(&ch, 1));
+    output_pending = true;
 }
 
 void vdu_clearscr() {
-    ::clear();
+    backend->clear_screen();
+    output_pending = true;
 }
 
 void vdu_cleareos() {
-    ::clrtobot();
+    backend->clear_eos();
+    output_pending = true;
 }
 
 void vdu_scrollup(int n) {
-    ::scrollok(stdscr, true);
-    ::scrl(n);
-    ::scrollok(stdscr, false);
+    backend->scroll_up(n);
+    output_pending = true;
 }
 
 void vdu_deletelines(int n) {
-    ::insdelln(-n);
-    vdu_flush();
+    backend->delete_lines(n);
+    output_pending = true;
 }
 
 void vdu_insertlines(int n) {
-    ::insdelln(n);
-    vdu_flush();
+    backend->insert_lines(n);
+    output_pending = true;
 }
 
 void vdu_insertchars(scr_col_range n) {
-    int limit = int(n);
-    for (int i = 0; i < limit; ++i)
-        ::insch(chtype(' '));
-    vdu_flush();
+    backend->insert_chars(n);
+    output_pending = true;
 }
 
 void vdu_deletechars(scr_col_range n) {
-    int limit = int(n);
-    for (int i = 0; i < limit; ++i)
-        ::delch();
-    vdu_flush();
+    backend->delete_chars(n);
+    output_pending = true;
 }
 
 void vdu_displaycrlf() {
-    int y = getcury(stdscr);
-    if (y == LINES - 1)
+    int y = backend->cursor_row();
+    if (y == backend->height())
         vdu_scrollup(1);
     else
         y += 1;
-    ::move(y, 0);
-    vdu_flush();
+    vdu_movecurs(1, y);
 }
 
 void vdu_take_back_key(key_code_range key) {
-    ::ungetch(unmassage_key(key));
+    backend->take_back_key(key);
 }
 
 void vdu_new_introducer(key_code_range key) {
@@ -191,15 +407,17 @@ void vdu_new_introducer(key_code_range key) {
     }
 }
 
+bool vdu_key_pending(key_code_range &key) {
+    // Look at the next key, if one has already been typed, without waiting
+    // and without sending any pending output.  The key remains to be read.
+    if (backend == nullptr)
+        return false;
+    return backend->key_pending(key);
+}
+
 key_code_range vdu_get_key() {
     vdu_flush();
-    int raw_key;
-    do {
-        raw_key = ::getch();
-    } while (raw_key == ERR);
-    if (raw_key == KEY_RESIZE && g_winchange)
-        *g_winchange = true;
-    return massage_key(raw_key);
+    return backend->get_key();
 }
 
 void vdu_get_input(
@@ -211,7 +429,7 @@ void vdu_get_input(
     vdu_attr_normal();
     get.fill(' ');
 
-    int maxlen = ::COLS - getcurx(stdscr);
+    int maxlen = backend->width() - backend->cursor_col() + 1;
     if (get_len > maxlen)
         get_len = maxlen;
 
@@ -221,9 +439,10 @@ void vdu_get_input(
         if ((outlen > 0) && ((key == BS) || (key == DEL))) {
             get_len += 1;
             outlen -= 1;
-            ::addch(BS);
-            ::addch(SPC);
-            ::addch(BS);
+            int col = backend->cursor_col() - 1;
+            vdu_movecurs(col, backend->cursor_row());
+            vdu_displaych(SPC);
+            vdu_movecurs(col, backend->cursor_row());
         } else {
             if ((key < 0) || contains(CONTROL_CHARS, int(key))) {
                 vdu_beep();
@@ -231,7 +450,7 @@ void vdu_get_input(
                 get_len -= 1;
                 outlen += 1;
                 get[outlen] = key;
-                ::addch(chtype(key));
+                vdu_displaych(char(int(key)));
             }
         }
         key = vdu_get_key();
@@ -247,7 +466,7 @@ void vdu_get_text(int str_len, str_object &str, strlen_range &outlen) {
     vdu_flush();
 
     outlen = 0;
-    int maxlen = ::COLS - getcurx(stdscr);
+    int maxlen = backend->width() - backend->cursor_col() + 1;
     if (str_len > maxlen)
         str_len = maxlen;
 
@@ -259,8 +478,7 @@ void vdu_get_text(int str_len, str_object &str, strlen_range &outlen) {
         } else {
             if (in_insert_mode)
                 vdu_insertchars(1);
-            ::addch(chtype(key));
-            ::refresh();
+            vdu_displaych(char(int(key)));
             outlen += 1;
             str[outlen] = key;
             str_len -= 1;
@@ -485,6 +703,8 @@ bool vdu_init(terminal_info_type &terminal_info, bool &ctrl_c_flag, bool &wincha
     terminal_info.width = 80;
     terminal_info.height = 4;
     if (sys_istty()) {
+        if (status_line)
+            curses.reserve_status_line();
         vdu_setup = ::initscr() != NULL;
         if (vdu_setup) {
             ::raw();
@@ -495,6 +715,13 @@ bool vdu_init(terminal_info_type &terminal_info, bool &ctrl_c_flag, bool &wincha
             ::idlok(stdscr, true);
             ::idcok(stdscr, true);
             ::scrollok(stdscr, false);
+            peek_win = ::newwin(1, 1, 0, 0);
+            if (peek_win != nullptr) {
+                ::keypad(peek_win, true);
+                ::nodelay(peek_win, true);
+                ::untouchwin(peek_win);
+            }
+            backend = &curses;
             terminal_info.width = ::COLS;
             terminal_info.height = ::LINES;
             vdu_clearscr();
@@ -506,27 +733,54 @@ bool vdu_init(terminal_info_type &terminal_info, bool &ctrl_c_flag, bool &wincha
     return false;
 }
 
+void vdu_init_backend(
+    vdu_backend &new_backend,
+    terminal_info_type &terminal_info,
+    bool &ctrl_c_flag,
+    bool &winchange_flag
+) {
+    g_ctrl_c = &ctrl_c_flag;
+    g_winchange = &winchange_flag;
+    backend = &new_backend;
+    if (status_line)
+        backend->reserve_status_line();
+    terminal_info.width = backend->width();
+    terminal_info.height = backend->height();
+    vdu_clearscr();
+    vdu_flush();
+}
+
 void vdu_free() {
-    if (vdu_setup) {
+    if (peek_win != nullptr) {
+        ::delwin(peek_win);
+        peek_win = nullptr;
+    }
+    if (backend != nullptr) {
+        vdu_display_status("");
+        backend->set_region(backend->height());
         vdu_scrollup(1);
-        vdu_movecurs(1, ::LINES);
+        vdu_movecurs(1, backend->height());
         vdu_flush();
-        ::endwin();
+        if (backend == &curses)
+            ::endwin();
+        backend = nullptr;
     }
+    status_line = false;
+    status_win = nullptr;
 }
 
 void vdu_get_new_dimensions(scr_col_range &new_x, scr_row_range &new_y) {
-    ::endwin();
-    ::refresh();
-    new_x = scr_col_range(::COLS);
-    new_y = scr_row_range(::LINES);
+    int width;
+    int height;
+    backend->new_dimensions(width, height);
+    new_x = scr_col_range(width);
+    new_y = scr_row_range(height);
 }
 
 void vdu_attr_bold() {
-    attron(A_BOLD);
+    backend->bold(true);
 }
 
 void vdu_attr_normal() {
-    attroff(A_BOLD);
-    attroff(A_REVERSE);
+    backend->bold(false);
 }
@@ -3,12 +3,34 @@
 
 #include "type.h"
 
+class vdu_backend;
+
 void vdu_movecurs(scr_col_range x, scr_row_range y);
 
+// Send all output accumulated since the last flush to the terminal.
 void vdu_flush();
+// Flush output produced part way through a command, for example by a
+// window update in a span.  If adaptive, the flush is skipped while the
+// terminal still appears busy with the previous update, so that a slow
+// link only shows the states it has time for.  The final state is shown
+// by the vdu_flush done before waiting for input.
+void vdu_flush_progress(bool adaptive);
+// Number of times vdu_flush has actually updated the terminal.
+unsigned long vdu_refresh_count();
 
 void vdu_beep();
 
+// Keep the bottom line of the terminal for a status line.  Must be called
+// before vdu_init, which then leaves the line out of the terminal height.
+void vdu_reserve_status_line();
+// Replace the text of the status line, if there is one.
+void vdu_display_status(std::string_view str);
+
+// Keep the clearing, scrolling, and line insertion and deletion done by
+// the other routines to rows 1..bottom of the terminal.  The rows below
+// are only changed by writing to them.  Reset by a resize.
+void vdu_set_region(scr_row_range bottom);
+
 void vdu_displaych(char ch);
 void vdu_displaystr(std::string_view str, int opts);
 void vdu_displaystr(scr_col_range strlen, const char *str, int opts);
@@ -31,6 +53,7 @@ void vdu_take_back_key(key_code_range key);
 
 void vdu_new_introducer(key_code_range key);
 
+bool vdu_key_pending(key_code_range &key);
 key_code_range vdu_get_key();
 
 void vdu_get_input(
@@ -49,6 +72,12 @@ void vdu_keyboard_init(
 );
 
 [[nodiscard]] bool vdu_init(terminal_info_type &terminal_info, bool &ctrl_c_flag, bool &winchange_flag);
+void vdu_init_backend(
+    vdu_backend &backend,
+    terminal_info_type &terminal_info,
+    bool &ctrl_c_flag,
+    bool &winchange_flag
+);
 
 void vdu_free();
 
@@ -0,0 +1,61 @@
+/** @file vdu_backend.h
+ * Interface between the vdu routines and the terminal.
+ *
+ * All terminal output and keyboard input done by the vdu routines goes
+ * through a backend.  vdu_init installs the curses backend, and
+ * vdu_init_backend installs any other, for example to drive the screen
+ * code without a terminal.  Rows and columns are numbered from 1.
+ */
+
+#ifndef VDU_BACKEND_H
+#define VDU_BACKEND_H
+
+#include "type.h"
+
+#include <string_view>
+
+class vdu_backend {
+public:
+    virtual ~vdu_backend() = default;
+
+    virtual int width() const = 0;
+    virtual int height() const = 0;
+    virtual int cursor_col() const = 0;
+    virtual int cursor_row() const = 0;
+
+    virtual void move_cursor(int col, int row) = 0;
+    virtual void put(std::string_view str) = 0; // Clipped at the right margin.
+    virtual void bold(bool on) = 0;
+    virtual void clear_eol() = 0;
+    virtual void clear_eos() = 0;
+    virtual void clear_screen() = 0;
+    virtual void scroll_up(int n) = 0;
+    virtual void insert_lines(int n) = 0;
+    virtual void delete_lines(int n) = 0;
+    virtual void insert_chars(int n) = 0;
+    virtual void delete_chars(int n) = 0;
+    virtual void beep() = 0;
+    // Take the bottom line of the terminal for a status line, which is then
+    // not counted in height() and not touched by the other output routines.
+    // Must be done before any output.
+    virtual void reserve_status_line() = 0;
+    // Replace the text of the status line.
+    virtual void put_status(std::string_view str) = 0;
+    // Keep clear_screen, clear_eos, scroll_up, insert_lines and delete_lines
+    // within rows 1..bottom, leaving the rows below to be written on their
+    // own.  The region is the whole height until set, and after a resize.
+    virtual void set_region(int bottom) = 0;
+    // Send the output accumulated since the last update to the terminal.
+    virtual void update() = 0;
+
+    // Wait for the next key.
+    virtual key_code_range get_key() = 0;
+    // Return the next key, if there is one, without waiting or removing it.
+    virtual bool key_pending(key_code_range &key) = 0;
+    virtual void take_back_key(key_code_range key) = 0;
+
+    // Find out the size of the terminal after it has been resized.
+    virtual void new_dimensions(int &width, int &height) = 0;
+};
+
+#endif // !defined(VDU_BACKEND_H)
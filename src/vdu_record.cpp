@@ -0,0 +1,149 @@
+/** @file vdu_record.cpp
+ * A vdu backend that records output, see vdu_record.h.
+ */
+
+#include "vdu_record.h"
+
+#include <algorithm>
+
+vdu_recorder::vdu_recorder(int width, int height, bool keep_output)
+    : vs(width, height), keep(keep_output), byte_count(0), update_count(0), new_width(width),
+      new_height(height), has_status(false) {}
+
+void vdu_recorder::resize(int width, int height) {
+    new_width = width;
+    new_height = height;
+}
+
+void vdu_recorder::push_key(key_code_range key) {
+    keys.push_back(key);
+}
+
+void vdu_recorder::reset() {
+    out.clear();
+    byte_count = 0;
+    update_count = 0;
+}
+
+int vdu_recorder::width() const {
+    return vs.width();
+}
+
+int vdu_recorder::height() const {
+    return has_status ? vs.height() - 1 : vs.height();
+}
+
+int vdu_recorder::cursor_col() const {
+    return vs.col();
+}
+
+int vdu_recorder::cursor_row() const {
+    return vs.row();
+}
+
+void vdu_recorder::move_cursor(int col, int row) {
+    vs.move(col, row);
+}
+
+void vdu_recorder::put(std::string_view str) {
+    vs.put(str);
+}
+
+void vdu_recorder::bold(bool on) {
+    vs.bold(on);
+}
+
+void vdu_recorder::clear_eol() {
+    vs.clear_eol();
+}
+
+void vdu_recorder::clear_eos() {
+    vs.clear_eos();
+}
+
+void vdu_recorder::clear_screen() {
+    vs.clear();
+}
+
+void vdu_recorder::scroll_up(int n) {
+    vs.scroll_up(n);
+}
+
+void vdu_recorder::insert_lines(int n) {
+    vs.insert_lines(n);
+}
+
+void vdu_recorder::delete_lines(int n) {
+    vs.delete_lines(n);
+}
+
+void vdu_recorder::insert_chars(int n) {
+    vs.insert_chars(n);
+}
+
+void vdu_recorder::delete_chars(int n) {
+    vs.delete_chars(n);
+}
+
+void vdu_recorder::beep() {
+    const char bel = '\a';
+    byte_count += 1;
+    if (keep)
+        out += bel;
+}
+
+void vdu_recorder::reserve_status_line() {
+    has_status = true;
+    vs.set_region(vs.height() - 1);
+}
+
+void vdu_recorder::put_status(std::string_view str) {
+    status = str;
+}
+
+void vdu_recorder::set_region(int bottom) {
+    vs.set_region(std::min(bottom, height()));
+}
+
+void vdu_recorder::update() {
+    if (has_status) {
+        int col = vs.col();
+        int row = vs.row();
+        vs.move(1, vs.height());
+        vs.put(status);
+        vs.clear_eol();
+        vs.move(col, row);
+    }
+    std::string rendered = vs.render();
+    byte_count += rendered.size();
+    update_count += 1;
+    if (keep)
+        out += rendered;
+}
+
+key_code_range vdu_recorder::get_key() {
+    if (keys.empty())
+        return 0;
+    key_code_range key = keys.front();
+    keys.pop_front();
+    return key;
+}
+
+bool vdu_recorder::key_pending(key_code_range &key) {
+    if (keys.empty())
+        return false;
+    key = keys.front();
+    return true;
+}
+
+void vdu_recorder::take_back_key(key_code_range key) {
+    keys.push_front(key);
+}
+
+void vdu_recorder::new_dimensions(int &width, int &height) {
+    if (new_width != vs.width() || new_height != vs.height())
+        vs.resize(new_width, new_height);
+    vs.set_region(this->height());
+    width = vs.width();
+    height = this->height();
+}
@@ -0,0 +1,85 @@
+/** @file vdu_record.h
+ * A vdu backend that records output instead of driving a terminal.
+ *
+ * Output is rendered into a vscreen, and each update appends the escape
+ * sequences a real terminal would have been sent.  The bytes are counted,
+ * and kept if asked for, so that redraw cost can be measured and the
+ * screen code exercised without a terminal.  Keys are taken from a queue
+ * filled by the caller.  A status line, if reserved, is the bottom row of
+ * the vscreen.
+ */
+
+#ifndef VDU_RECORD_H
+#define VDU_RECORD_H
+
+#include "vdu_backend.h"
+#include "vscreen.h"
+
+#include <deque>
+#include <string>
+
+class vdu_recorder : public vdu_backend {
+public:
+    vdu_recorder(int width, int height, bool keep_output);
+
+    // Simulate the terminal changing size, seen at the next new_dimensions.
+    void resize(int width, int height);
+    void push_key(key_code_range key);
+
+    const vscreen &screen() const {
+        return vs;
+    }
+    const std::string &output() const {
+        return out;
+    }
+    size_t bytes() const {
+        return byte_count;
+    }
+    size_t updates() const {
+        return update_count;
+    }
+    void reset();
+
+    int width() const override;
+    int height() const override;
+    int cursor_col() const override;
+    int cursor_row() const override;
+
+    void move_cursor(int col, int row) override;
+    void put(std::string_view str) override;
+    void bold(bool on) override;
+    void clear_eol() override;
+    void clear_eos() override;
+    void clear_screen() override;
+    void scroll_up(int n) override;
+    void insert_lines(int n) override;
+    void delete_lines(int n) override;
+    void insert_chars(int n) override;
+    void delete_chars(int n) override;
+    void beep() override;
+    void reserve_status_line() override;
+    void put_status(std::string_view str) override;
+    void set_region(int bottom) override;
+    void update() override;
+
+    // Returns 0 (CONTROL-@) if there are no keys queued.
+    key_code_range get_key() override;
+    bool key_pending(key_code_range &key) override;
+    void take_back_key(key_code_range key) override;
+
+    void new_dimensions(int &width, int &height) override;
+
+private:
+    vscreen vs;
+    bool keep;
+    std::string out;
+    size_t byte_count;
+    size_t update_count;
+    int new_width;
+    int new_height;
+    bool has_status;
+    std::string status;
+    std::deque<key_code_range> keys;
+};
+
+#endif // !defined(VDU_RECORD_H)
@@ -0,0 +1,417 @@
+/** @file vscreen.cpp
+ * In-memory model of a character terminal screen, see vscreen.h.
+ */
+
+#include "vscreen.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+
+namespace {
+    const char BLANK = ' ';
+    const char NORMAL = 0;
+    const char BOLD = 1;
+
+    // The cost in bytes of a cursor movement, roughly.  Runs of unchanged
+    // characters shorter than this are rewritten rather than skipped.
+    const int MOVE_COST = 6;
+    // Scroll only if it saves redrawing at least this many rows.
+    const int MIN_SCROLL_GAIN = 2;
+    // Shift a row sideways only if it lines up this many more characters.
+    const int MIN_SLIDE_GAIN = 2 * MOVE_COST;
+    // How many changed rows to search for a horizontal shift.
+    const size_t MAX_SLIDE_PROBES = 3;
+    // Length and number of the pieces of a row used to find the shift.
+    const int SLIDE_ANCHOR = 4;
+    const int SLIDE_ANCHORS = 4;
+
+    const char CSI[] = "\x1b[";
+} // namespace
+
+vscreen::vscreen(int width, int height) {
+    resize(width, height);
+}
+
+vscreen::row_image vscreen::blank_row() const {
+    return row_image{std::string(cols, BLANK), std::string(cols, NORMAL), 0, false};
+}
+
+size_t vscreen::row_hash(const row_image &r) const {
+    if (!r.hash_valid) {
+        r.hash = std::hash<std::string>{}(r.text) * 31 + std::hash<std::string>{}(r.attr);
+        r.hash_valid = true;
+    }
+    return r.hash;
+}
+
+void vscreen::touch(int row) {
+    screen[row - 1].hash_valid = false;
+}
+
+void vscreen::resize(int width, int height) {
+    cols = std::max(width, 1);
+    rows = std::max(height, 1);
+    screen.assign(rows, blank_row());
+    terminal.assign(rows, blank_row());
+    cur_col = 1;
+    cur_row = 1;
+    cur_bold = false;
+    region_rows = rows;
+    invalidate();
+}
+
+void vscreen::invalidate() {
+    terminal_unknown = true;
+    term_row = 0;
+    term_col = 0;
+    term_bold = false;
+}
+
+void vscreen::set_region(int bottom) {
+    region_rows = std::clamp(bottom, 1, rows);
+}
+
+void vscreen::move(int col, int row) {
+    cur_col = std::clamp(col, 1, cols);
+    cur_row = std::clamp(row, 1, rows);
+}
+
+void vscreen::bold(bool on) {
+    cur_bold = on;
+}
+
+void vscreen::put(std::string_view str) {
+    // Text is clipped at the right margin, as the vdu routines do.
+    row_image &r = screen[cur_row - 1];
+    for (char ch : str) {
+        if (cur_col > cols)
+            break;
+        r.text[cur_col - 1] = ch;
+        r.attr[cur_col - 1] = (cur_bold && ch != BLANK) ? BOLD : NORMAL;
+        cur_col += 1;
+    }
+    touch(cur_row);
+}
+
+void vscreen::clear_eol() {
+    if (cur_col > cols)
+        return;
+    row_image &r = screen[cur_row - 1];
+    std::fill(r.text.begin() + cur_col - 1, r.text.end(), BLANK);
+    std::fill(r.attr.begin() + cur_col - 1, r.attr.end(), NORMAL);
+    touch(cur_row);
+}
+
+void vscreen::clear_eos() {
+    clear_eol();
+    if (cur_row < region_rows)
+        std::fill(screen.begin() + cur_row, screen.begin() + region_rows, blank_row());
+}
+
+void vscreen::clear() {
+    std::fill(screen.begin(), screen.begin() + region_rows, blank_row());
+    cur_col = 1;
+    cur_row = 1;
+}
+
+void vscreen::scroll_up(int n) {
+    n = std::clamp(n, 0, region_rows);
+    screen.erase(screen.begin(), screen.begin() + n);
+    screen.insert(screen.begin() + region_rows - n, n, blank_row());
+}
+
+void vscreen::insert_lines(int n) {
+    if (cur_row > region_rows)
+        return;
+    const auto bottom = screen.begin() + region_rows;
+    n = std::clamp(n, 0, region_rows - cur_row + 1);
+    screen.erase(bottom - n, bottom);
+    screen.insert(screen.begin() + cur_row - 1, n, blank_row());
+}
+
+void vscreen::delete_lines(int n) {
+    if (cur_row > region_rows)
+        return;
+    n = std::clamp(n, 0, region_rows - cur_row + 1);
+    screen.erase(screen.begin() + cur_row - 1, screen.begin() + cur_row - 1 + n);
+    screen.insert(screen.begin() + region_rows - n, n, blank_row());
+}
+
+void vscreen::insert_chars(int n) {
+    if (cur_col > cols)
+        return;
+    row_image &r = screen[cur_row - 1];
+    n = std::clamp(n, 0, cols - cur_col + 1);
+    r.text.insert(cur_col - 1, n, BLANK);
+    r.attr.insert(cur_col - 1, n, NORMAL);
+    r.text.resize(cols);
+    r.attr.resize(cols);
+    touch(cur_row);
+}
+
+void vscreen::delete_chars(int n) {
+    if (cur_col > cols)
+        return;
+    row_image &r = screen[cur_row - 1];
+    n = std::clamp(n, 0, cols - cur_col + 1);
+    r.text.erase(cur_col - 1, n);
+    r.attr.erase(cur_col - 1, n);
+    r.text.append(n, BLANK);
+    r.attr.append(n, NORMAL);
+    touch(cur_row);
+}
+
+std::string_view vscreen::row_text(int row) const {
+    return screen[row - 1].text;
+}
+
+void vscreen::emit_move(std::string &out, int col, int row) {
+    if (term_row == row && term_col == col)
+        return;
+    if (term_row == row && col == 1) {
+        out += '\r';
+    } else {
+        out += CSI;
+        out += std::to_string(row);
+        out += ';';
+        out += std::to_string(col);
+        out += 'H';
+    }
+    term_row = row;
+    term_col = col;
+}
+
+void vscreen::emit_bold(std::string &out, bool on) {
+    if (term_bold != on) {
+        out += CSI;
+        out += on ? "1m" : "0m";
+        term_bold = on;
+    }
+}
+
+void vscreen::render_scroll(std::string &out) {
+    // Look for a vertical shift that lines up more rows with the terminal
+    // than are lined up already.  Blank rows don't count, they are cheap to
+    // draw and would otherwise swamp the comparison.
+    const size_t blank_hash = row_hash(blank_row());
+    std::vector<size_t> want(rows);
+    std::vector<size_t> have(rows);
+    for (int r = 0; r < rows; ++r) {
+        want[r] = row_hash(screen[r]);
+        have[r] = row_hash(terminal[r]);
+    }
+    auto score = [&](int shift) {
+        int matches = 0;
+        for (int r = std::max(0, -shift); r < rows && r + shift < rows; ++r) {
+            if (want[r] != blank_hash && want[r] == have[r + shift])
+                matches += 1;
+        }
+        return matches;
+    };
+    int best_shift = 0;
+    int best_score = score(0) + MIN_SCROLL_GAIN - 1;
+    for (int shift = 1 - rows; shift < rows; ++shift) {
+        if (shift == 0)
+            continue;
+        int s = score(shift);
+        if (s > best_score) {
+            best_score = s;
+            best_shift = shift;
+        }
+    }
+    if (best_shift == 0)
+        return;
+
+    emit_move(out, 1, 1);
+    emit_bold(out, false);
+    out += CSI;
+    if (best_shift > 0) {
+        out += std::to_string(best_shift) + 'M';
+        terminal.erase(terminal.begin(), terminal.begin() + best_shift);
+        terminal.insert(terminal.end(), best_shift, blank_row());
+    } else {
+        out += std::to_string(-best_shift) + 'L';
+        terminal.erase(terminal.end() + best_shift, terminal.end());
+        terminal.insert(terminal.begin(), -best_shift, blank_row());
+    }
+    term_row = 0; // Terminals differ about where this leaves the cursor.
+}
+
+int vscreen::slide_score(int row, int shift) const {
+    // Number of non-blank characters that would be in place if the terminal
+    // row were shifted left by shift columns (right if negative).
+    const row_image &want = screen[row - 1];
+    const row_image &have = terminal[row - 1];
+    int matches = 0;
+    for (int c = std::max(0, -shift); c < cols && c + shift < cols; ++c) {
+        if (want.text[c] != BLANK && want.text[c] == have.text[c + shift] &&
+            want.attr[c] == have.attr[c + shift])
+            matches += 1;
+    }
+    return matches;
+}
+
+int vscreen::find_slide() const {
+    // Look for a horizontal shift, as left after sliding the screen sideways.
+    // All the rows will usually have moved the same distance, so the shift
+    // is looked for in the first few changed rows only.  Rather than trying
+    // every distance, a few short pieces of the new row are looked for in
+    // the old one, and only the distances they suggest are tried.
+    size_t probes = 0;
+    for (int r = 1; r <= rows && probes < MAX_SLIDE_PROBES; ++r) {
+        const row_image &want = screen[r - 1];
+        const row_image &have = terminal[r - 1];
+        if (row_hash(want) == row_hash(have))
+            continue;
+        probes += 1;
+        int shift = 0;
+        int best = slide_score(r, 0) + MIN_SLIDE_GAIN - 1;
+        const std::string_view old_text = have.text;
+        for (int p = 0; p + SLIDE_ANCHOR <= cols; p += std::max(cols / SLIDE_ANCHORS, 1)) {
+            const std::string_view anchor = std::string_view(want.text).substr(p, SLIDE_ANCHOR);
+            if (anchor.find_first_not_of(BLANK) == std::string_view::npos)
+                continue;
+            int tries = 0;
+            for (size_t at = old_text.find(anchor); at != std::string_view::npos && tries < cols;
+                 at = old_text.find(anchor, at + 1), ++tries) {
+                int s = int(at) - p;
+                if (s == 0)
+                    continue;
+                int score = slide_score(r, s);
+                if (score > best) {
+                    best = score;
+                    shift = s;
+                }
+            }
+        }
+        if (shift != 0)
+            return shift;
+    }
+    return 0;
+}
+
+void vscreen::render_slide(std::string &out, int row, int shift) {
+    // Shift the text of a terminal row with character insert/delete, if that
+    // lines up enough of it with the new image to be worth doing.
+    if (shift == 0 || slide_score(row, shift) < slide_score(row, 0) + MIN_SLIDE_GAIN)
+        return;
+    const int n = std::abs(shift);
+    row_image &have = terminal[row - 1];
+    emit_move(out, 1, row);
+    emit_bold(out, false);
+    out += CSI;
+    out += std::to_string(n);
+    if (shift > 0) {
+        out += 'P';
+        have.text.erase(0, n);
+        have.attr.erase(0, n);
+        have.text.append(n, BLANK);
+        have.attr.append(n, NORMAL);
+    } else {
+        out += '@';
+        have.text.insert(0, n, BLANK);
+        have.attr.insert(0, n, NORMAL);
+        have.text.resize(cols);
+        have.attr.resize(cols);
+        if (row == rows && have.text[cols - 1] != BLANK) {
+            // The bottom right corner is never written, so erase anything
+            // pushed into it.
+            emit_move(out, cols, row);
+            out += CSI;
+            out += 'K';
+            have.text[cols - 1] = BLANK;
+            have.attr[cols - 1] = NORMAL;
+        }
+    }
+    have.hash_valid = false;
+}
+
+void vscreen::render_row(std::string &out, int row) {
+    const row_image &want = screen[row - 1];
+    row_image &have = terminal[row - 1];
+    auto same = [&](int c) {
+        return want.text[c] == have.text[c] && want.attr[c] == have.attr[c];
+    };
+
+    // Writing the bottom right corner would scroll some terminals.
+    const int limit = (row == rows) ? cols - 1 : cols;
+    int first = 0;
+    while (first < limit && same(first))
+        first += 1;
+    if (first == limit)
+        return;
+    int last = limit - 1;
+    while (same(last))
+        last -= 1;
+    int want_end = limit;
+    while (want_end > 0 && want.text[want_end - 1] == BLANK)
+        want_end -= 1;
+
+    // Blank the tail of the row with a single erase if that is cheaper.
+    const int eol_from = std::max(first, want_end);
+    const bool use_eol = last >= want_end && last - eol_from + 1 > 3;
+    const int write_end = use_eol ? want_end : last + 1;
+
+    int c = first;
+    if (c < write_end)
+        emit_move(out, c + 1, row);
+    while (c < write_end) {
+        if (same(c)) {
+            int e = c;
+            while (e < write_end && same(e))
+                e += 1;
+            if (e - c > MOVE_COST) {
+                c = e;
+                emit_move(out, c + 1, row);
+                continue;
+            }
+        }
+        emit_bold(out, want.attr[c] == BOLD);
+        out += want.text[c];
+        have.text[c] = want.text[c];
+        have.attr[c] = want.attr[c];
+        c += 1;
+        term_col += 1;
+    }
+    if (term_col > cols)
+        term_row = 0; // Some terminals wrap, some don't.
+    if (use_eol) {
+        emit_move(out, eol_from + 1, row);
+        emit_bold(out, false);
+        out += CSI;
+        out += 'K';
+        std::fill(have.text.begin() + eol_from, have.text.end(), BLANK);
+        std::fill(have.attr.begin() + eol_from, have.attr.end(), NORMAL);
+    }
+    have.hash_valid = false;
+}
+
+std::string vscreen::render() {
+    std::string out;
+    if (terminal_unknown) {
+        out += CSI;
+        out += "0m";
+        out += CSI;
+        out += 'H';
+        out += CSI;
+        out += "2J";
+        terminal.assign(rows, blank_row());
+        term_row = 1;
+        term_col = 1;
+        term_bold = false;
+        terminal_unknown = false;
+    }
+    render_scroll(out);
+    const int shift = find_slide();
+    for (int r = 1; r <= rows; ++r) {
+        const row_image &want = screen[r - 1];
+        const row_image &have = terminal[r - 1];
+        if (row_hash(want) != row_hash(have) || want.text != have.text || want.attr != have.attr) {
+            render_slide(out, r, shift);
+            render_row(out, r);
+        }
+    }
+    emit_move(out, std::min(cur_col, cols), cur_row);
+    return out;
+}
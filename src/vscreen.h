@@ -0,0 +1,102 @@
+/** @file vscreen.h
+ * In-memory model of a character terminal screen.
+ *
+ * A vscreen holds two images of the screen: the one the terminal is known to
+ * be showing, and the one built up by the output operations since the last
+ * render.  render() works out the escape sequences (ANSI/VT100) that take the
+ * terminal from the first image to the second.  Rows are compared by hash, so
+ * unchanged rows cost nothing, rows that have only moved are shifted with
+ * line insert/delete, text that has moved sideways is shifted with character
+ * insert/delete, and only the changed columns of other rows are sent.
+ *
+ * Rows and columns are numbered from 1, as they are for the vdu routines.
+ */
+
+#ifndef VSCREEN_H
+#define VSCREEN_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+class vscreen {
+public:
+    vscreen(int width, int height);
+
+    int width() const {
+        return cols;
+    }
+    int height() const {
+        return rows;
+    }
+    int col() const {
+        return cur_col;
+    }
+    int row() const {
+        return cur_row;
+    }
+
+    // Resize the screen.  The terminal is assumed to be blank afterwards.
+    void resize(int width, int height);
+    // Forget what the terminal is showing, the next render redraws it all.
+    void invalidate();
+    // Limit scrolling, line insert/delete and clearing to rows 1 to bottom,
+    // leaving the rows below for output that is managed separately.
+    void set_region(int bottom);
+
+    void move(int col, int row);
+    void bold(bool on);
+    void put(std::string_view str);
+    void clear_eol();
+    void clear_eos();
+    void clear();
+    void scroll_up(int n);
+    void insert_lines(int n);
+    void delete_lines(int n);
+    void insert_chars(int n);
+    void delete_chars(int n);
+
+    // The text of a row as it will appear after the next render.
+    std::string_view row_text(int row) const;
+
+    // Returns the output needed to bring the terminal up to date, and
+    // records that the terminal now shows the new image.
+    std::string render();
+
+private:
+    struct row_image {
+        std::string text;
+        std::string attr; // 0 for normal, 1 for bold
+        mutable size_t hash;
+        mutable bool hash_valid;
+    };
+
+    int cols;
+    int rows;
+    int region_rows;
+    int cur_col;
+    int cur_row;
+    bool cur_bold;
+    std::vector<row_image> screen;   // Image being built.
+    std::vector<row_image> terminal; // Image on the terminal.
+    bool terminal_unknown;
+
+    // Terminal state while rendering.
+    int term_col;
+    int term_row; // 0 if the terminal cursor position isn't known
+    bool term_bold;
+
+    row_image blank_row() const;
+    size_t row_hash(const row_image &r) const;
+    void touch(int row);
+    void emit_move(std::string &out, int col, int row);
+    void emit_bold(std::string &out, bool on);
+    void render_scroll(std::string &out);
+    int slide_score(int row, int shift) const;
+    int find_slide() const;
+    void render_slide(std::string &out, int row, int shift);
+    void render_row(std::string &out, int row);
+};
+
+#endif // !defined(VSCREEN_H)
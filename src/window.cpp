@@ -219,8 +219,12 @@ bool window_command(commands command, leadparam rept, int count, bool from_span)
 
     case commands::cmd_window_update:
         cmd_success = true;
-        if (ludwig_mode == ludwig_mode_type::ludwig_screen)
+        if (ludwig_mode == ludwig_mode_type::ludwig_screen) {
             screen_fixup();
+            bool adaptive =
+                current_frame->options.contains(frame_options_elts::opt_adaptive_redraw);
+            vdu_flush_progress(adaptive);
+        }
         break;
 
     default:
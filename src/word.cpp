@@ -24,12 +24,407 @@
 
 #include "word.h"
 
+#include "journal.h"
 #include "line.h"
 #include "mark.h"
 #include "screen.h"
 #include "text.h"
+#include "undo.h"
 #include "var.h"
 
+#include <algorithm>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+    bool word_set_text(line_ptr line, const str_object &text, strlen_range used) {
+        // Replace the text of a line in one go.  The marks are left alone.
+        if (!line_unshare(line))
+            return false;
+        undo_line_change(line);
+        journal_line_change(line);
+        if ((used > line->len) && !line_change_length(line, used))
+            return false;
+        if (line->used > 0)
+            line->str->fill(' ', 1, line->used);
+        if (used > 0)
+            line->str->copy(text, 1, used);
+        line->used = used;
+        if (line->scr_row_nr != 0)
+            screen_draw_line(line);
+        return true;
+    }
+
+    // A word of a line being filled, and where the fill puts it.
+    struct fill_word {
+        int first;    // The columns of the word in its line.
+        int last;
+        int out_line; // The index of the filled line it goes on,
+        int out_col;  // and its column there.
+    };
+
+    // A line being filled, with its words.
+    struct fill_source {
+        line_ptr line;
+        std::vector<fill_word> words;
+    };
+
+    // The result of filling a run of lines.  The filled lines replace the
+    // source lines, so the first of them is where the first source line was.
+    struct fill_plan {
+        std::vector<fill_source> sources;
+        int out_lines = 0;
+        int dot_line = 0; // The index of the filled line to leave dot on,
+        int dot_col = 1;  // which may be the line just after them.  A
+                          // dot_line of -1 lets dot move with the text.
+        int count = 0;    // What is left of the count after the fill.
+    };
+
+    void fill_read(fill_plan &plan, line_ptr line) {
+        fill_source &source = plan.sources.emplace_back();
+        source.line = line;
+        std::string_view text = line->str->slice(1, line->used);
+        size_t pos = text.find_first_not_of(' ');
+        while (pos != std::string_view::npos) {
+            size_t end = text.find(' ', pos);
+            if (end == std::string_view::npos)
+                end = text.size();
+            source.words.push_back({static_cast<int>(pos) + 1, static_cast<int>(end), 0, 0});
+            pos = text.find_first_not_of(' ', end);
+        }
+    }
+
+    bool fill_fetch(fill_plan &plan, size_t index) {
+        // Make sure plan.sources[index] has been read, if that line is in
+        // the paragraph.
+        if (index < plan.sources.size())
+            return true;
+        line_ptr line = plan.sources.back().line->flink;
+        if ((line == nullptr) || (line->used == 0))
+            return false;
+        fill_read(plan, line);
+        return true;
+    }
+
+    int fill_place(fill_word &word, int out_line, int out_col) {
+        // Put a word at out_col on a filled line, and return its last column.
+        word.out_line = out_line;
+        word.out_col = out_col;
+        return out_col + word.last - word.first;
+    }
+
+    int fill_indent(const fill_source &source, int margin_left) {
+        // The column a line that isn't the first of its paragraph starts at,
+        // unless it has already been moved to the left margin.  Ludwig's
+        // fill has always stopped looking for the text at the last character,
+        // so a line whose only text is its last character isn't moved right.
+        int first = source.words[0].first;
+        if (first == source.line->used)
+            return std::min(first, margin_left);
+        return margin_left;
+    }
+
+    void fill_stop(fill_plan &plan, size_t src, size_t next_word, int col, int out) {
+        // Give up at the line at src, as Ludwig's fill always has.  The
+        // lines before it stay filled, what is left of it starts at col on
+        // filled line out, and the lines after it are left alone.
+        plan.sources.resize(src + 1);
+        std::vector<fill_word> &words = plan.sources[src].words;
+        int first = words[next_word].first;
+        if ((out == 0) && (col == first))
+            return; // Nothing has changed.
+        for (size_t i = next_word; i < words.size(); ++i)
+            fill_place(words[i], out, col + words[i].first - first);
+        plan.out_lines = out + 1;
+    }
+
+    void fill_stop_dot(fill_plan &plan, size_t src, int out, bool indented) {
+        // Leave dot at the left margin of filled line out, which starts
+        // with the line at src, after giving up.  Dot is put there before
+        // the line is indented, so moves right with the text if it is, as
+        // it does if it has not left the first line.
+        plan.dot_line = (out == 0) ? -1 : out;
+        plan.dot_col = current_frame->margin_left;
+        const fill_word &first = plan.sources[src].words[0];
+        if (indented && (first.out_col > first.first))
+            plan.dot_col = std::min(plan.dot_col + first.out_col - first.first, MAX_STRLENP);
+    }
+
+    bool fill_plan_lines(int count, fill_plan &plan) {
+        /*
+          Work out the fill of the lines from dot without changing anything,
+          taking the same steps as Ludwig's fill always has when it moved the
+          text a line at a time.  A line is filled by pulling up as many
+          words from the next line as fit after one space, or by splitting
+          it after the last word that fits.  Spaces between words from the
+          same line are kept.  Every line but the first of a paragraph
+          starts at the left margin, apart from the odd cases fill_indent
+          keeps.  Each line filled counts against count, as does each line
+          whose words are all pulled up, but not the lines made by
+          splitting.
+
+          Returns false if a line can't be split or would be too long.  The
+          plan then stops at that line, keeping the lines filled before it.
+        */
+
+        int margin_left = current_frame->margin_left;
+        int margin_right = current_frame->margin_right;
+        line_ptr first_line = current_frame->dot->line;
+        plan.count = count;
+        if ((count <= 0) || (first_line->used == 0))
+            return true;
+        fill_read(plan, first_line);
+        size_t src = 0;
+        size_t next_word = 0;
+        int col = plan.sources[0].words[0].first; // 0 until the line is placed.
+        if ((first_line->blink != nullptr) && (first_line->blink->used != 0))
+            col = 0;
+        int out = 0;
+        while ((plan.count > 0) && fill_fetch(plan, src)) {
+            std::vector<fill_word> &words = plan.sources[src].words;
+            size_t line_src = src;
+            bool indented = col == 0;
+            if (indented)
+                col = fill_indent(plan.sources[src], margin_left);
+            fill_word &start = words[next_word];
+            int used = col + words.back().last - start.first;
+            if (used > MAX_STRLEN) {
+                // The line can't be indented, so is left where it is.
+                fill_stop(plan, src, next_word, start.first, out);
+                fill_stop_dot(plan, src, out, false);
+                return false;
+            }
+            if (used > margin_right) {
+                // Split the line after the last word that fits.
+                size_t i = next_word + 1;
+                int split_used = col + start.last - start.first;
+                if (split_used <= margin_right) {
+                    while (split_used + words[i].last - words[i - 1].last <= margin_right) {
+                        split_used += words[i].last - words[i - 1].last;
+                        i += 1;
+                    }
+                }
+                if ((split_used > margin_right) || (split_used <= margin_left)) {
+                    fill_stop(plan, src, next_word, col, out);
+                    fill_stop_dot(plan, src, out, indented);
+                    return false;
+                }
+                for (size_t j = next_word; j < i; ++j)
+                    fill_place(words[j], out, col + words[j].first - start.first);
+                next_word = i;
+                col = margin_left;
+                out += 1;
+                continue;
+            }
+            for (size_t i = next_word; i < words.size(); ++i)
+                fill_place(words[i], out, col + words[i].first - start.first);
+
+            // Pull words up from the following lines.
+            bool leave_dot_alone = false;
+            bool pulled_part = false;
+            size_t taken = 0;
+            src += 1;
+            while ((margin_right - used - 1 > 0) && fill_fetch(plan, src)) {
+                std::vector<fill_word> &next_words = plan.sources[src].words;
+                int next_used = used + 1 + next_words[0].last - next_words[0].first + 1;
+                if (next_used <= margin_right) {
+                    used = fill_place(next_words[0], out, used + 2);
+                    taken = 1;
+                    while ((taken < next_words.size()) &&
+                           (used + next_words[taken].last - next_words[taken - 1].last <=
+                            margin_right)) {
+                        used = fill_place(
+                            next_words[taken],
+                            out,
+                            used + next_words[taken].first - next_words[taken - 1].last
+                        );
+                        taken += 1;
+                    }
+                }
+                if (taken < next_words.size()) {
+                    // The rest of the line is moved to the left margin, if
+                    // it fits there.
+                    const fill_word &rest = next_words[taken];
+                    if (margin_left + next_words.back().last - rest.first > MAX_STRLEN) {
+                        int rest_col = rest.first;
+                        if (taken > 0)
+                            rest_col -= next_words[taken - 1].last;
+                        fill_stop(plan, src, taken, rest_col, out + 1);
+                        if ((taken > 0) || (src > line_src + 1)) {
+                            // Dot was left after the last words pulled up.
+                            plan.dot_line = out;
+                            plan.dot_col = used + 1;
+                        } else {
+                            fill_stop_dot(plan, line_src, out, indented);
+                        }
+                        return false;
+                    }
+                    pulled_part = true;
+                    break;
+                }
+                plan.count -= 1;
+                src += 1;
+                taken = 0;
+                if (plan.count <= 0) {
+                    leave_dot_alone = true;
+                    break;
+                }
+            }
+            out += 1;
+            plan.count -= 1;
+            if (leave_dot_alone) {
+                plan.out_lines = out;
+                plan.dot_line = out - 1;
+                plan.dot_col = used + 1;
+                return true;
+            }
+            next_word = taken;
+            // What is left of a line that words were pulled up from has
+            // been moved to the left margin already.
+            col = pulled_part ? margin_left : 0;
+            if (pulled_part && (plan.count <= 0)) {
+                // The rest of the line the last words came from is moved
+                // to the left margin, but is not filled.
+                std::vector<fill_word> &rest = plan.sources[src].words;
+                for (size_t i = next_word; i < rest.size(); ++i)
+                    fill_place(rest[i], out, col + rest[i].first - rest[next_word].first);
+                plan.out_lines = out + 1;
+                plan.dot_line = out;
+                plan.dot_col = margin_left;
+                return true;
+            }
+        }
+        plan.out_lines = out;
+        plan.dot_line = out;
+        plan.dot_col = margin_left;
+        return true;
+    }
+
+    void fill_mark_position(
+        const fill_source &source, bool leads, int col, int &out_line, int &out_col
+    ) {
+        // Find where the fill puts a column of a source line.  Marks in the
+        // spaces dropped between words stay with the word before them.  If
+        // the line still starts a filled line (leads), marks in its leading
+        // spaces stay put unless those spaces are taken out.
+        const std::vector<fill_word> &words = source.words;
+        auto word =
+            std::ranges::find_if(words, [col](const fill_word &w) { return w.last >= col; });
+        if (word == words.end()) {
+            const fill_word &last = words.back();
+            out_line = last.out_line;
+            out_col = last.out_col + last.last - last.first + 1;
+        } else if (col >= word->first) {
+            out_line = word->out_line;
+            out_col = word->out_col + col - word->first;
+        } else if (word == words.begin()) {
+            out_line = word->out_line;
+            out_col = leads ? std::min(col, word->out_col) : word->out_col;
+        } else {
+            const fill_word &prev = *(word - 1);
+            out_line = prev.out_line;
+            if ((word->out_line == prev.out_line) &&
+                (word->out_col - prev.out_col == word->first - prev.first))
+                out_col = prev.out_col + col - prev.first;
+            else
+                out_col = prev.out_col + prev.last - prev.first + 1;
+        }
+    }
+
+    bool fill_apply(const fill_plan &plan) {
+        // Replace the source lines of a fill with the filled lines.
+
+        if (plan.out_lines == 0)
+            return true;
+        int nr_sources = plan.sources.size();
+        std::vector<str_object> texts(plan.out_lines, BLANK_STRING);
+        std::vector<strlen_range> used(plan.out_lines, 0);
+        for (const auto &source : plan.sources) {
+            for (const auto &word : source.words) {
+                int len = word.last - word.first + 1;
+                texts[word.out_line].copy(*source.line->str, word.first, len, word.out_col);
+                used[word.out_line] = word.out_col + len - 1;
+            }
+        }
+
+        // Work out where the marks go before the text moves.
+        std::vector<std::tuple<mark_ptr, int, int>> mark_moves;
+        for (int i = 0; i < nr_sources; ++i) {
+            const fill_source &source = plan.sources[i];
+            bool leads = (i == 0) || (plan.sources[i - 1].words.back().out_line !=
+                                      source.words[0].out_line);
+            for (const auto &mark : source.line->marks) {
+                int out_line;
+                int out_col;
+                fill_mark_position(source, leads, mark->col, out_line, out_col);
+                mark_moves.emplace_back(mark, out_line, out_col);
+            }
+        }
+
+        // Make any extra lines needed, and put them in after the source lines.
+        line_ptr first_line = nullptr;
+        line_ptr last_line = nullptr;
+        std::vector<line_ptr> out_lines;
+        for (int i = 0; (i < plan.out_lines) && (i < nr_sources); ++i)
+            out_lines.push_back(plan.sources[i].line);
+        if (plan.out_lines > nr_sources) {
+            if (!lines_create(plan.out_lines - nr_sources, first_line, last_line))
+                return false;
+            for (line_ptr line = first_line; line != nullptr; line = line->flink) {
+                int i = out_lines.size();
+                if (!line_change_length(line, used[i])) {
+                    lines_destroy(first_line, last_line);
+                    return false;
+                }
+                line->str->copy(texts[i], 1, used[i]);
+                line->used = used[i];
+                out_lines.push_back(line);
+            }
+        }
+
+        // Rewrite the source lines that are kept.
+        for (int i = 0; (i < plan.out_lines) && (i < nr_sources); ++i) {
+            if (!word_set_text(out_lines[i], texts[i], used[i]))
+                return false;
+        }
+        if (first_line != nullptr) {
+            if (!lines_inject(first_line, last_line, out_lines[nr_sources - 1]->flink)) {
+                lines_destroy(first_line, last_line);
+                return false;
+            }
+        }
+        for (auto &[mark, out_line, out_col] : mark_moves) {
+            if (!mark_create(out_lines[out_line], out_col, mark))
+                return false;
+        }
+
+        // Take out the source lines not needed.
+        if (plan.out_lines < nr_sources) {
+            first_line = plan.sources[plan.out_lines].line;
+            last_line = plan.sources[nr_sources - 1].line;
+            if (!lines_extract(first_line, last_line))
+                return false;
+            if (!lines_destroy(first_line, last_line))
+                return false;
+        }
+
+        current_frame->text_modified = true;
+        if (plan.dot_line < 0)
+            return true; // Dot has moved with its line.
+        line_ptr dot_line = out_lines.back();
+        if (plan.dot_line >= plan.out_lines)
+            dot_line = dot_line->flink;
+        else
+            dot_line = out_lines[plan.dot_line];
+        if (!mark_create(dot_line, plan.dot_col, current_frame->dot))
+            return false;
+        return mark_create(dot_line, plan.dot_col, current_frame->marks[MARK_MODIFIED]);
+    }
+
+} // namespace
+
 bool word_fill(leadparam rept, int count) {
     /* Description:
        This routine takes the current line and moves words within
@@ -37,24 +432,10 @@ bool word_fill(leadparam rept, int count) {
        If necessary, it will grab stuff from the next line.
        nYF => Upset (at most) n lines after this one
        It preserves multiple spaces.
+       The whole fill is worked out first, and the lines are then
+       rewritten once each, rather than moving the text a word at a time.
     */
 
-    col_range start_char;
-    col_range end_char;
-    col_range old_end;
-    int line_count;
-    int space_to_add;
-    line_ptr this_line;
-    mark_ptr here;
-    mark_ptr there;
-    mark_ptr old_here;
-    mark_ptr old_there;
-    bool leave_dot_alone;
-
-    bool result = false;
-    leave_dot_alone = false;
-    here = nullptr;
-    there = nullptr;
     if (rept == leadparam::pindef)
         count = MAXINT;
     if (rept == leadparam::none) {
@@ -62,239 +443,22 @@ bool word_fill(leadparam rept, int count) {
         rept = leadparam::pint;
     }
     if (rept == leadparam::pint) {
-        line_count = count;
-        this_line = current_frame->dot->line;
+        int line_count = count;
+        const_line_ptr this_line = current_frame->dot->line;
         while ((line_count > 0) && (this_line->used > 0)) {
             this_line = this_line->flink;
             line_count -= 1;
             if (this_line == nullptr)
-                goto l99;
+                return false;
         }
         if (line_count != 0)
-            goto l99;
-    }
-    while ((count > 0) && (current_frame->dot->line->used > 0)) {
-        // with current_frame^,dot^,line^ do
-        if (current_frame->dot->line->flink == nullptr) // on EOP line so abort
-            goto l99;
-        // adjust the current line to the margins
-        if (current_frame->dot->line->blink != nullptr) {
-            if (current_frame->dot->line->blink->used != 0) {
-                // this is not the first line of a paragraph so adjust to left margin
-                start_char = 1;
-                while (((*current_frame->dot->line->str)[start_char] == ' ') &&
-                       (start_char < current_frame->dot->line->used))
-                    start_char += 1;
-                if ((start_char < current_frame->margin_left) &&
-                    (start_char < current_frame->dot->line->used)) {
-                    if (!mark_create(current_frame->dot->line, start_char, here))
-                        goto l99;
-                    if (!text_insert(
-                            true, 1, BLANK_STRING, current_frame->margin_left - start_char, here
-                        ))
-                        goto l99;
-                    mark_destroy(here);
-                } else {
-                    // we might have to remove some spaces
-                    start_char = current_frame->margin_left;
-                    end_char = current_frame->margin_left;
-                    if (end_char < current_frame->dot->line->used) {
-                        while (((*current_frame->dot->line->str)[end_char] == ' ') &&
-                               (end_char < current_frame->dot->line->used))
-                            end_char += 1;
-                        if (end_char > 1) {
-                            if (!mark_create(current_frame->dot->line, start_char.value(), here))
-                                goto l99;
-                            if (!mark_create(current_frame->dot->line, end_char, there))
-                                goto l99;
-                            if (!text_remove(here, there))
-                                goto l99;
-                            mark_destroy(here);
-                            mark_destroy(there);
-                        }
-                    }
-                }
-            }
-        }
-        if (current_frame->dot->line->used > current_frame->margin_right) {
-            // We must split this line if possible
-            // 1. Scan back for first non-blank
-            end_char = current_frame->margin_right + 1;
-            if ((*current_frame->dot->line->str)[end_char] != ' ') {
-                while (((*current_frame->dot->line->str)[end_char] != ' ') &&
-                       (end_char > current_frame->margin_left))
-                    end_char -= 1;
-                if (end_char == current_frame->margin_left)
-                    goto l99;
-            }
-            start_char = end_char;
-            while (((*current_frame->dot->line->str)[end_char] == ' ') &&
-                   (end_char > current_frame->margin_left))
-                end_char -= 1;
-            if (end_char == current_frame->margin_left)
-                goto l99; // Nothing to do
-            // 2. Scan forward for first non-blank
-            while ((*current_frame->dot->line->str)[start_char] == ' ')
-                start_char += 1;
-            // 3. Split the line at end_char and make sure the new line
-            //    starts with start_char at margin_left
-            //    Make sure the DOT stays on THIS LINE
-            if (!mark_create(current_frame->dot->line, start_char, here))
-                goto l99;
-            if (current_frame->dot->col > end_char)
-                if (!mark_create(current_frame->dot->line, end_char, current_frame->dot))
-                    goto l99;
-            if (!text_split_line(here, current_frame->margin_left, there))
-                goto l99;
-            if (!mark_destroy(here))
-                goto l99;
-            if (!mark_destroy(there))
-                goto l99;
-            if (rept != leadparam::pindef)
-                count += 1;
-        } else {
-            // need to get stuff from the next line
-        l3:;
-            // 1. Figure out how many chars we can fit in
-            space_to_add = current_frame->margin_right - current_frame->dot->line->used -
-                           1; // Allow for 1 space
-            // 2. See if we can find a word to fit
-            start_char = 1;
-            if ((space_to_add > 0) && (current_frame->dot->line->flink->used != 0)) {
-                while ((*current_frame->dot->line->flink->str)[start_char] == ' ')
-                    start_char += 1;
-                end_char = start_char;
-                old_end = end_char;
-                while (end_char <= current_frame->dot->line->flink->used) {
-                    while ((*current_frame->dot->line->flink->str)[end_char] == ' ')
-                        end_char += 1;
-                    while (((*current_frame->dot->line->flink->str)[end_char] != ' ') &&
-                           (end_char < current_frame->dot->line->flink->used))
-                        end_char += 1;
-                    if (end_char == current_frame->dot->line->flink->used)
-                        end_char += 1;
-                    if (space_to_add < (end_char - start_char))
-                        end_char = current_frame->dot->line->flink->used + 1;
-                    else
-                        old_end = end_char;
-                }
-                if (((old_end - start_char) <= space_to_add) && (old_end != start_char)) {
-                    // Hooray !! It will fit
-                    old_here = nullptr;
-                    old_there = nullptr;
-                    if (!mark_create(current_frame->dot->line->flink, start_char, here))
-                        goto l99;
-                    if (!mark_create(current_frame->dot->line->flink, start_char, old_here))
-                        goto l99;
-                    if (!mark_create(current_frame->dot->line->flink, old_end, there))
-                        goto l99;
-                    if (!mark_create(current_frame->dot->line->flink, old_end, old_there))
-                        goto l99;
-                    current_frame->dot->col =
-                        current_frame->dot->line->used + 2; // Allow for a space !
-                    // Copy the text
-                    if (!text_move(true, 1, here, there, current_frame->dot, here, there))
-                        goto l99;
-                    // Copy the marks
-                    if (!marks_shift(
-                            current_frame->dot->line->flink,
-                            old_here->col,
-                            old_there->col - old_here->col,
-                            here->line,
-                            here->col
-                        ))
-                        goto l99;
-                    // Now wipe out the old Grungy text
-                    // First though, put the old_here and there marks back!
-                    if (!mark_create(current_frame->dot->line->flink, 1, old_here))
-                        goto l99;
-                    if (!mark_create(current_frame->dot->line->flink, old_end, old_there))
-                        goto l99;
-                    if (!text_remove(old_here, old_there))
-                        goto l99;
-                    mark_destroy(old_here);
-                    mark_destroy(old_there);
-                    // Now clean up the next line
-                    // If it is now empty, delete it
-                    // with dot->line^ do
-                    if (current_frame->dot->line->flink->used == 0) {
-                        this_line = current_frame->dot->line->flink;
-                        if (!marks_squeeze(
-                                current_frame->dot->line->flink,
-                                1,
-                                current_frame->dot->line->flink->flink,
-                                1
-                            ))
-                            goto l99;
-                        if (!lines_extract(this_line, this_line))
-                            goto l99;
-                        if (!lines_destroy(this_line, this_line))
-                            goto l99;
-                        count -= 1;
-                        if (count > 0)
-                            goto l3; // Go back and have another go
-                        // Put DOT here, so we can have another go if we want
-                        leave_dot_alone = true;
-                    }
-                }
-                // Now make sure the first char in this line is at LM
-                // with dot->line^ do
-                if ((count > 0) && (current_frame->dot->line->flink->used != 0)) {
-                    start_char = 1;
-                    while ((*current_frame->dot->line->flink->str)[start_char] == ' ')
-                        start_char += 1;
-                    if (!mark_create(current_frame->dot->line->flink, start_char, there))
-                        goto l99;
-                    if (start_char < current_frame->margin_left) {
-                        // Must insert some chars here
-                        if (!text_insert(
-                                true,
-                                1,
-                                BLANK_STRING,
-                                current_frame->margin_left - start_char,
-                                there
-                            ))
-                            goto l99;
-                    } else {
-                        if (!mark_create(
-                                current_frame->dot->line->flink, current_frame->margin_left, here
-                            ))
-                            goto l99;
-                        if (!text_remove(here, there))
-                            goto l99;
-                    }
-                }
-                if (here != nullptr)
-                    if (!mark_destroy(here))
-                        goto l99;
-                if (there != nullptr)
-                    if (!mark_destroy(there))
-                        goto l99;
-            }
-        }
-        count -= 1;
-        if (!leave_dot_alone) {
-            if (!mark_create(
-                    current_frame->dot->line->flink, current_frame->margin_left, current_frame->dot
-                ))
-                goto l99;
-        }
-        current_frame->text_modified = true;
-        if (!mark_create(
-                current_frame->dot->line,
-                current_frame->dot->col,
-                current_frame->marks[MARK_MODIFIED]
-            ))
-            goto l99;
+            return false;
     }
-    result = (count <= 0) || (rept == leadparam::pindef);
-l99:;
-    // Clean up those temporary marks if necessary
-    if (here != nullptr)
-        mark_destroy(here);
-    if (there != nullptr)
-        mark_destroy(there);
-    return result;
+    fill_plan plan;
+    bool planned = fill_plan_lines(count, plan);
+    if (!fill_apply(plan))
+        return false;
+    return planned && ((plan.count <= 0) || (rept == leadparam::pindef));
 }
 
 bool word_centre(leadparam rept, int count) {
@@ -398,12 +562,14 @@ bool word_justify(leadparam rept, int count) {
     int line_count;
     int space_to_add;
     const_line_ptr this_line;
-    mark_ptr here;
-    double fill_ratio;
+    double fill_ratio = 0;
     double debit;
+    str_object new_str;
+    int new_used;
+    int src_col;
+    std::vector<std::pair<int, int>> inserts;
 
     bool result = false;
-    here = nullptr;
     if (rept == leadparam::pindef)
         count = MAXINT;
     if ((rept == leadparam::none) || (rept == leadparam::plus)) {
@@ -454,6 +620,12 @@ bool word_justify(leadparam rept, int count) {
             fill_ratio = 1.0 * space_to_add / holes;
         debit = 0.0;
         start_char = end_char;
+        // 3. Build the justified line, and put it back in one go.  The
+        //    spaces go in at the start of each hole.
+        new_str = BLANK_STRING;
+        new_used = 0;
+        src_col = 1;
+        inserts.clear();
         for (i = 1; i <= holes; ++i) {
             // Find a hole
             while ((*current_frame->dot->line->str)[start_char] != ' ')
@@ -461,18 +633,34 @@ bool word_justify(leadparam rept, int count) {
             debit += fill_ratio;
             space_to_add = static_cast<int>(debit + 0.5);
             if (space_to_add > 0) {
-                here = nullptr;
-                if (!mark_create(current_frame->dot->line, start_char, here))
-                    goto l2;
-                if (!text_insert(true, 1, BLANK_STRING, space_to_add, here))
-                    goto l2;
-                if (!mark_destroy(here))
-                    goto l2;
+                new_str.copy(
+                    *current_frame->dot->line->str, src_col, start_char - src_col, new_used + 1
+                );
+                new_used += start_char - src_col + space_to_add;
+                src_col = start_char;
+                inserts.emplace_back(start_char, space_to_add);
                 debit -= space_to_add;
             }
             while ((*current_frame->dot->line->str)[start_char] == ' ')
                 start_char += 1;
         }
+        new_str.copy(
+            *current_frame->dot->line->str,
+            src_col,
+            current_frame->dot->line->used + 1 - src_col,
+            new_used + 1
+        );
+        new_used += current_frame->dot->line->used + 1 - src_col;
+        for (const auto &mark : current_frame->dot->line->marks) {
+            int new_col = mark->col;
+            for (const auto &[hole_col, spaces] : inserts) {
+                if (hole_col <= mark->col)
+                    new_col += spaces;
+            }
+            mark->col = std::min(new_col, MAX_STRLENP);
+        }
+        if (!word_set_text(current_frame->dot->line, new_str, new_used))
+            goto l2;
     l1:;
         count -= 1;
         if (!mark_create(
@@ -489,9 +677,6 @@ bool word_justify(leadparam rept, int count) {
     }
     result = (count <= 0) || (rept == leadparam::pindef);
 l2:;
-    // Clean up those temporary marks if necessary
-    if (here != nullptr)
-        mark_destroy(here);
     return result;
 }
 
@@ -505,12 +690,12 @@ bool word_squeeze(leadparam rept, int count) {
     col_range end_char;
     int line_count;
     const_line_ptr this_line;
-    mark_ptr here;
-    mark_ptr there;
+    str_object new_str;
+    int new_used;
+    int src_col;
+    std::vector<std::pair<int, int>> removals;
 
     bool result = false;
-    here = nullptr;
-    there = nullptr;
     if (rept == leadparam::pindef)
         count = MAXINT;
     if ((rept == leadparam::none) || (rept == leadparam::plus)) {
@@ -536,31 +721,52 @@ bool word_squeeze(leadparam rept, int count) {
         start_char = 1;
         while ((*current_frame->dot->line->str)[start_char] == ' ')
             start_char += 1;
+        // Build the squeezed line, keeping the last space of each run, and
+        // put it back in one go.
+        src_col = 1;
+        new_used = 0;
+        removals.clear();
         // with line^ do
         do {
             while (((*current_frame->dot->line->str)[start_char] != ' ') &&
                    (start_char < current_frame->dot->line->used))
                 start_char += 1;
             if ((*current_frame->dot->line->str)[start_char] != ' ')
-                goto l1; // Nothing more to do
+                break; // Nothing more to do
             end_char = start_char;
             while ((*current_frame->dot->line->str)[end_char] == ' ')
                 end_char += 1;
             if ((end_char - start_char) > 1) {
-                here = nullptr;
-                if (!mark_create(current_frame->dot->line, start_char, here))
-                    goto l2;
-                there = nullptr;
-                if (!mark_create(current_frame->dot->line, end_char - 1, there))
-                    goto l2;
-                if (!text_remove(here, there))
-                    goto l2;
-                start_char = here->col;
-            } else {
-                start_char = end_char;
+                new_str.copy(
+                    *current_frame->dot->line->str, src_col, start_char - src_col, new_used + 1
+                );
+                new_used += start_char - src_col;
+                src_col = end_char - 1;
+                removals.emplace_back(start_char, end_char - 1 - start_char);
             }
+            start_char = end_char;
         } while (true);
-    l1:;
+        if (!removals.empty()) {
+            new_str.copy(
+                *current_frame->dot->line->str,
+                src_col,
+                current_frame->dot->line->used + 1 - src_col,
+                new_used + 1
+            );
+            new_used += current_frame->dot->line->used + 1 - src_col;
+            for (const auto &mark : current_frame->dot->line->marks) {
+                int new_col = mark->col;
+                for (const auto &[gap_col, spaces] : removals) {
+                    if (mark->col >= gap_col + spaces)
+                        new_col -= spaces;
+                    else if (mark->col > gap_col)
+                        new_col -= mark->col - gap_col;
+                }
+                mark->col = new_col;
+            }
+            if (!word_set_text(current_frame->dot->line, new_str, new_used))
+                goto l2;
+        }
         count -= 1;
         if (!mark_create(
                 current_frame->dot->line->flink, current_frame->margin_left, current_frame->dot
@@ -576,11 +782,6 @@ bool word_squeeze(leadparam rept, int count) {
     }
     result = (count == 0) || (rept == leadparam::pindef);
 l2:;
-    // Clean up those temporary marks if necessary
-    if (here != nullptr)
-        mark_destroy(here);
-    if (there != nullptr)
-        mark_destroy(there);
     return result;
 }
 
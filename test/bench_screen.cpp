@@ -0,0 +1,120 @@
+/**
+ * @file bench_screen.cpp
+ * Screen redraw benchmark.
+ *
+ * Runs the screen code against a recording vdu backend, so no terminal is
+ * needed, and reports the time taken and the bytes that would have been sent
+ * to the terminal for scrolling, sliding, paging and resizing a large frame.
+ *
+ * usage: ludwig_bench [lines [width height]]
+ */
+
+#include "ludwiglib.h"
+#include "mark.h"
+#include "screen.h"
+#include "session.h"
+#include "value.h"
+#include "var.h"
+#include "vdu.h"
+#include "vdu_record.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+namespace {
+
+std::string make_text(int lines) {
+    // Lines of assorted lengths, some wider than the screen.
+    std::string text;
+    const std::string words = "the quick brown fox jumps over the lazy dog ";
+    for (int i = 0; i < lines; ++i) {
+        text += std::to_string(i) + ' ';
+        int len = (i * 37) % 200;
+        for (int j = 0; j < len; ++j)
+            text += words[j % words.size()];
+        text += '\n';
+    }
+    return text;
+}
+
+void move_dot(int lines) {
+    // Move the dot down, going back to the top at the end of the frame.
+    line_ptr line = current_frame->dot->line;
+    for (int i = 0; i < lines; ++i) {
+        if (line->flink == nullptr || line->flink->flink == nullptr)
+            line = current_frame->first_group->first_line;
+        else
+            line = line->flink;
+    }
+    if (!mark_create(line, 1, current_frame->dot))
+        std::exit(EXIT_FAILURE);
+}
+
+void run(vdu_recorder &term, const char *name, int count, const std::function<void(int)> &op) {
+    term.reset();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; ++i) {
+        op(i);
+        vdu_flush();
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    std::printf(
+        "%-8s %8d %10.2f %10.2f %10.1f %8zu\n",
+        name,
+        count,
+        elapsed.count() / 1000.0,
+        elapsed.count() / count,
+        double(term.bytes()) / count,
+        term.updates()
+    );
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+    int lines = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int width = argc > 3 ? std::atoi(argv[2]) : 132;
+    int height = argc > 3 ? std::atoi(argv[3]) : 50;
+
+    session_initialize();
+    load_command_table(true);
+    vdu_recorder term(width, height, false);
+    vdu_init_backend(term, terminal_info, tt_controlc, tt_winchanged);
+    initial_scr_width = terminal_info.width;
+    initial_scr_height = terminal_info.height;
+    initial_margin_right = terminal_info.width;
+    ludwig_mode = ludwig_mode_type::ludwig_screen;
+    vdu_new_introducer(command_introducer);
+    scr_msg_row = terminal_info.height + 1;
+    if (!session_create_frames() || !ludwiglib_set_text(make_text(lines)))
+        return EXIT_FAILURE;
+    screen_fixup();
+    vdu_flush();
+
+    std::printf("%d lines on a %dx%d screen\n\n", lines, width, height);
+    std::printf(
+        "%-8s %8s %10s %10s %10s %8s\n", "Op", "Count", "Total ms", "Avg us", "Bytes/op", "Updates"
+    );
+    run(term, "scroll", 5000, [](int) {
+        move_dot(1);
+        screen_fixup();
+    });
+    run(term, "page", 1000, [](int) {
+        move_dot(terminal_info.height);
+        screen_fixup();
+    });
+    run(term, "slide", 1000, [](int i) { screen_slide(i % 2 == 0 ? 40 : -40); });
+    run(term, "resize", 200, [&](int i) {
+        if (i % 2 == 0)
+            term.resize(width - 20, height - 10);
+        else
+            term.resize(width, height);
+        tt_winchanged = true;
+        screen_fixup();
+    });
+    vdu_free();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,43 @@
+/**
+ * @file session_fixture.h
+ * Helpers shared by the tests that drive editing sessions.
+ *
+ * Each session runs on its own thread so that it has fresh state, and
+ * doesn't disturb the global state used by the other tests.
+ */
+
+#ifndef SESSION_FIXTURE_H
+#define SESSION_FIXTURE_H
+
+#include "ludwiglib.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+// Run f in a new session, returning whatever it returns.
+template <typename F> auto in_new_session(F f) {
+    return std::async(std::launch::async, f).get();
+}
+
+// Run commands in the current session, requiring them to succeed.
+inline void run(std::string_view commands) {
+    code_ptr code = ludwiglib_compile(commands);
+    REQUIRE(code != nullptr);
+    REQUIRE(ludwiglib_run(code));
+    ludwiglib_discard(code);
+}
+
+// The whole of a file, or nothing if it can't be read.
+inline std::string contents(const std::filesystem::path &file) {
+    std::ifstream in(file, std::ios::binary);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+#endif // !defined(SESSION_FIXTURE_H)
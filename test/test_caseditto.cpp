@@ -0,0 +1,42 @@
+/**
+ * @file test_caseditto.cpp
+ * Tests for the case change and ditto commands.
+ */
+
+#include "ludwiglib.h"
+#include "session_fixture.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+namespace {
+
+std::string transform(const std::string &commands, const std::string &text) {
+    std::string result;
+    bool ok = in_new_session([&]() {
+        REQUIRE(ludwiglib_open(true));
+        return ludwiglib_transform(commands, text, result);
+    });
+    REQUIRE(ok);
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("case change works along the line", "[caseditto]") {
+    REQUIRE(transform("3j>*u", "mixed Case text\n") == "mixED CASE TEXT\n");
+    REQUIRE(transform("11j<*l", "MIXED CASE\n") == "mixed case\n");
+    REQUIRE(transform(">*e", "mIXED cASE-tEXT\n") == "Mixed Case-Text\n");
+}
+
+TEST_CASE("case change with a mark covers the whole region", "[caseditto]") {
+    const std::string text = "hello world\nsecond line\nthird\n";
+    REQUIRE(transform("6jma3j@*u", text) == "hello WORLD\nSECond line\nthird\n");
+    REQUIRE(transform("6jma3j@*e", text) == "hello World\nSecond line\nthird\n");
+    REQUIRE(transform("3j1m2a2j@1*u", text) == "helLO WORLD\nSECOND LINE\nTHird\n");
+}
+
+TEST_CASE("ditto inserts text from the line above or below", "[caseditto]") {
+    REQUIRE(transform("a>\"", "abc\nxy\n") == "abc\nabcxy\n");
+    REQUIRE(transform("2j>'", "abcd\nwxyz\n") == "abyzcd\nwxyz\n");
+}
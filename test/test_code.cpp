@@ -482,6 +482,57 @@ TEST_CASE("code_compile error handling", "[code][compile][integration]") {
     cleanup_code_globals();
 }
 
+TEST_CASE("code_compile_partial detects incomplete commands", "[code][compile][integration]") {
+    init_code_globals();
+
+    SECTION("compiles complete commands") {
+        span_object span;
+        REQUIRE(create_test_span(span, {"A", "I/text/"}));
+
+        bool incomplete = true;
+        REQUIRE(code_compile_partial(span, incomplete) == true);
+        REQUIRE(span.code != nullptr);
+
+        destroy_test_span(span);
+    }
+
+    SECTION("reports unterminated trailing parameter as incomplete") {
+        span_object span;
+        REQUIRE(create_test_span(span, {"A", "I/multi", "line"}));
+
+        bool incomplete = false;
+        REQUIRE(code_compile_partial(span, incomplete) == false);
+        REQUIRE(incomplete);
+        REQUIRE(span.code == nullptr);
+
+        destroy_test_span(span);
+    }
+
+    SECTION("reports unclosed compound command as incomplete") {
+        span_object span;
+        REQUIRE(create_test_span(span, {"3(A", "J"}));
+
+        bool incomplete = false;
+        REQUIRE(code_compile_partial(span, incomplete) == false);
+        REQUIRE(incomplete);
+
+        destroy_test_span(span);
+    }
+
+    SECTION("reports syntax errors as complete") {
+        span_object span;
+        REQUIRE(create_test_span(span, {"ZQ", "A"}));
+
+        bool incomplete = true;
+        REQUIRE(code_compile_partial(span, incomplete) == false);
+        REQUIRE_FALSE(incomplete);
+
+        destroy_test_span(span);
+    }
+
+    cleanup_code_globals();
+}
+
 TEST_CASE("code_compile compound commands", "[code][compile][integration]") {
     init_code_globals();
 
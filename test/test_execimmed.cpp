@@ -0,0 +1,63 @@
+/**
+ * @file test_execimmed.cpp
+ * Tests for running batch mode commands read from the standard input.
+ */
+
+#include "execimmed.h"
+#include "ludwiglib.h"
+#include "session_fixture.h"
+#include "var.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+namespace {
+
+// Run the commands in file as a batch mode session reading its standard
+// input would, returning the text they leave in the default frame.
+std::string run_batch(const std::filesystem::path &file, bool stream) {
+    return in_new_session([&]() {
+        REQUIRE(ludwiglib_open(true));
+        file_data.stream = stream;
+        int saved = ::dup(0);
+        int fd = ::open(file.c_str(), O_RDONLY);
+        REQUIRE(saved >= 0);
+        REQUIRE(fd >= 0);
+        ::dup2(fd, 0);
+        ::close(fd);
+        execute_immed();
+        ::dup2(saved, 0);
+        ::close(saved);
+        return ludwiglib_get_text();
+    });
+}
+
+} // namespace
+
+TEST_CASE("streamed commands match commands read all at once", "[execimmed]") {
+    auto file = std::filesystem::temp_directory_path() / "ludwig_test_stream.lud";
+    {
+        // The group and the exit handler each start in one chunk of a
+        // hundred lines and finish in the next.
+        std::ofstream out(file);
+        for (int i = 1; i <= 98; ++i)
+            out << "i/a/\n";
+        out << "(\n";      // Line 99.
+        out << "i/b/\n";   // Line 100.
+        out << ")\n";      // Line 101.
+        for (int i = 102; i <= 199; ++i)
+            out << "! Nothing but a comment.\n";
+        out << "g/zzz/\n"; // Line 200, which fails.
+        out << "[:i/c/]\n";
+        out << "i/d/\n";
+    }
+    std::string expected = std::string(98, 'a') + "bcd\n";
+
+    REQUIRE(run_batch(file, false) == expected);
+    REQUIRE(run_batch(file, true) == expected);
+    std::filesystem::remove(file);
+}
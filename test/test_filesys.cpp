@@ -0,0 +1,176 @@
+/**
+ * @file test_filesys.cpp
+ * Tests for saving and copying files part way through reading them.
+ */
+
+#include "filesys.h"
+#include "session_fixture.h"
+#include "sys.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+
+// Parse a Ludwig command line into data, as the editor does at start up.
+bool parse_command_line(const std::string &command_line, file_data_type &data) {
+    file_object input{};
+    input.zed = 'Z';
+    file_object output{};
+    output.zed = 'Z';
+    file_ptr input_ptr = &input;
+    file_ptr output_ptr = &output;
+    return in_new_session([&]() {
+        return filesys_parse(command_line, parse_type::parse_command, data, input_ptr, output_ptr);
+    });
+}
+
+} // namespace
+
+TEST_CASE("save copies the unread input and the lines already written", "[filesys]") {
+    auto dir = std::filesystem::temp_directory_path() / "ludwig_test_filesys";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    auto file = dir / "text.txt";
+    std::ofstream(file, std::ios::binary) << "one\ntwo\nthree\nfour\n\tfive\nsix\x01\nseven";
+
+    file_object input{};
+    input.zed = 'Z';
+    input.filename = file.string();
+    REQUIRE(filesys_create_open(&input, nullptr, true));
+    file_object output{};
+    output.zed = 'Z';
+    output.output_flag = true;
+    output.versions = 1;
+    REQUIRE(filesys_create_open(&output, &input, true));
+
+    // "one" has been written out, "two" and "three" are being edited.
+    str_object line;
+    strlen_range len;
+    for (int i = 0; i < 3; ++i)
+        REQUIRE(filesys_read(&input, line, len));
+    str_object edited;
+    edited.copy_n("ONE", 3);
+    REQUIRE(filesys_write(&output, &edited, 3));
+    int written = output.l_counter;
+    str_object frame;
+    frame.copy_n("TWO AND THREE", 13);
+    REQUIRE(filesys_write(&output, &frame, 13));
+
+    REQUIRE(filesys_save(&input, &output, written));
+    REQUIRE(contents(file) == "ONE\nTWO AND THREE\nfour\n        five\nsix\nseven\n");
+    // Input carries on after the lines being edited, and the new output
+    // starts with the lines already written.
+    REQUIRE(filesys_read(&input, line, len));
+    REQUIRE(std::string(line.slice(1, len)) == "four");
+    REQUIRE(output.l_counter == 1);
+    REQUIRE(sys_close(output.fd) == 0);
+    REQUIRE(contents(output.tnm) == "ONE\n");
+    REQUIRE(sys_close(input.fd) == 0);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("copy streams the rest of the input less trailing spaces", "[filesys]") {
+    auto dir = std::filesystem::temp_directory_path() / "ludwig_test_filesys_copy";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    auto file = dir / "text.txt";
+    std::ofstream(file, std::ios::binary) << "one\ntwo  \n\tthree\nfour \t\nfive";
+
+    file_object input{};
+    input.zed = 'Z';
+    input.filename = file.string();
+    REQUIRE(filesys_create_open(&input, nullptr, true));
+    file_object output{};
+    output.zed = 'Z';
+    output.output_flag = true;
+    output.versions = 1;
+    REQUIRE(filesys_create_open(&output, &input, true));
+
+    str_object line;
+    strlen_range len;
+    REQUIRE(filesys_read(&input, line, len));
+    REQUIRE(filesys_copy(&input, &output));
+    REQUIRE(input.eof);
+    REQUIRE(output.l_counter == 4);
+    REQUIRE(sys_close(output.fd) == 0);
+    REQUIRE(contents(output.tnm) == "two\n        three\nfour\nfive\n");
+    REQUIRE(sys_close(input.fd) == 0);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("copy handles large files mixing lines that need converting", "[filesys]") {
+    auto dir = std::filesystem::temp_directory_path() / "ludwig_test_filesys_large";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    auto file = dir / "text.txt";
+    // Enough lines to span several chunks, most of which need converting.
+    const int count = 80000;
+    std::string text;
+    std::string expected;
+    for (int i = 0; i < count; ++i) {
+        std::string n = std::to_string(i);
+        switch (i % 4) {
+        case 0:
+            text += "\tline " + n + "\n";
+            expected += "        line " + n + "\n";
+            break;
+        case 1:
+            text += "line " + n + "   \n";
+            expected += "line " + n + "\n";
+            break;
+        case 2:
+            text += "line\x01 " + n + "\n";
+            expected += "line " + n + "\n";
+            break;
+        default:
+            text += "line " + n + "\n";
+            expected += "line " + n + "\n";
+            break;
+        }
+    }
+    std::ofstream(file, std::ios::binary) << text;
+
+    file_object input{};
+    input.zed = 'Z';
+    input.filename = file.string();
+    REQUIRE(filesys_create_open(&input, nullptr, true));
+    file_object output{};
+    output.zed = 'Z';
+    output.output_flag = true;
+    output.versions = 1;
+    REQUIRE(filesys_create_open(&output, &input, true));
+
+    REQUIRE(filesys_copy(&input, &output));
+    REQUIRE(input.l_counter == count);
+    REQUIRE(output.l_counter == count);
+    REQUIRE(sys_close(output.fd) == 0);
+    REQUIRE(contents(output.tnm) == expected);
+    REQUIRE(sys_close(input.fd) == 0);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("streaming can't be combined with parallel workers", "[filesys]") {
+    file_data_type data{};
+    REQUIRE(parse_command_line("-S -M", data));
+    REQUIRE(data.stream);
+    data = file_data_type{};
+    REQUIRE_FALSE(parse_command_line("-S -p 2 one.txt two.txt", data));
+    REQUIRE(data.batch_files.empty());
+}
+
+TEST_CASE("the read-ahead window must be a positive number of lines", "[filesys]") {
+    file_data_type data{};
+    REQUIRE(parse_command_line("-w 50 -M", data));
+    REQUIRE(data.window == 50);
+    data = file_data_type{};
+    REQUIRE_FALSE(parse_command_line("-w 0 -M", data));
+    REQUIRE(data.window == 0);
+    REQUIRE_FALSE(parse_command_line("-w many -M", data));
+    REQUIRE(data.window == 0);
+}
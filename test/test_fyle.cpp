@@ -4,10 +4,19 @@
  */
 
 #include "fyle.h"
+#include "journal.h"
+#include "ludwiglib.h"
+#include "quit.h"
+#include "session_fixture.h"
+#include "undo.h"
+#include "var.h"
 
 #include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
 #include <memory>
 #include <string>
+#include <string_view>
 
 constexpr const std::string_view LONG_TEST_FILENAME =
     "/this/is/a/long/path/to/a/test/file/thats/too/long.txt";
@@ -72,3 +81,111 @@ TEST_CASE("file_name limits length", "[fyle]") {
         REQUIRE(result == "/---t");
     }
 }
+
+namespace {
+
+constexpr int WINDOW_TEST_LINES = 1000;
+constexpr size_t WINDOW_TEST_SIZE = 20;
+
+// Edit file with a read-ahead window, in a mode that keeps a journal.
+void edit_windowed(const std::filesystem::path &file) {
+    REQUIRE(ludwiglib_open(true));
+    ludwig_mode = ludwig_mode_type::ludwig_hardcopy;
+    file_data.window = WINDOW_TEST_SIZE;
+    run("fe'" + file.string() + "'");
+}
+
+// Run commands as one command of an interactive session.
+void command(std::string_view commands) {
+    undo_begin_command();
+    run(commands);
+}
+
+// The number of lines of the file read into the current frame so far.
+line_range lines_read() {
+    const_line_ptr eop = current_frame->last_group->last_line;
+    return eop->group->first_line_nr + eop->offset_nr - 1;
+}
+
+bool input_eof() {
+    return files[current_frame->input_file]->eof;
+}
+
+} // namespace
+
+TEST_CASE("a read-ahead window reads the file in as the dot moves", "[fyle]") {
+    auto dir = std::filesystem::temp_directory_path() / "ludwig_test_window";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    auto file = dir / "text.txt";
+    auto journal = dir / ("text.txt" + std::string(JOURNAL_SUFFIX));
+    {
+        std::ofstream out(file);
+        for (int i = 1; i <= WINDOW_TEST_LINES; ++i)
+            out << "line " << i << '\n';
+    }
+
+    SECTION("only about a window's worth is read when the file is opened") {
+        in_new_session([&]() {
+            edit_windowed(file);
+            line_range opened = lines_read();
+            REQUIRE(opened > static_cast<int>(WINDOW_TEST_SIZE));
+            REQUIRE(opened <= static_cast<line_range>(2 * WINDOW_TEST_SIZE));
+            // Further than half a window from the last line read, nothing more is read.
+            command("2a");
+            REQUIRE(lines_read() == opened);
+            command(">a");
+            REQUIRE(lines_read() > opened);
+            REQUIRE_FALSE(input_eof());
+            quit_close_files();
+        });
+    }
+
+    SECTION("undo keeps the lines read ahead") {
+        in_new_session([&]() {
+            edit_windowed(file);
+            command("i/x/");
+            line_range opened = lines_read();
+            command(">a");
+            line_range ahead = lines_read();
+            REQUIRE(ahead > opened);
+            command("uu");
+            REQUIRE(lines_read() == ahead);
+            REQUIRE(current_frame->first_group->first_line->str->slice(1, 6) == "line 1");
+            quit_close_files();
+        });
+    }
+
+    SECTION("the journal is only kept once all of an unmodified file is read") {
+        in_new_session([&]() {
+            edit_windowed(file);
+            while (!input_eof()) {
+                REQUIRE_FALSE(std::filesystem::exists(journal));
+                command(">a");
+            }
+            REQUIRE(lines_read() == WINDOW_TEST_LINES);
+            REQUIRE(std::filesystem::exists(journal));
+            quit_close_files();
+        });
+        REQUIRE_FALSE(std::filesystem::exists(journal));
+
+        in_new_session([&]() {
+            edit_windowed(file);
+            command("i/x/");
+            while (!input_eof())
+                command(">a");
+            REQUIRE_FALSE(std::filesystem::exists(journal));
+            quit_close_files();
+        });
+    }
+
+    SECTION("FP still fills the frame") {
+        in_new_session([&]() {
+            edit_windowed(file);
+            command("fp");
+            REQUIRE(lines_read() == WINDOW_TEST_LINES);
+            quit_close_files();
+        });
+    }
+    std::filesystem::remove_all(dir);
+}
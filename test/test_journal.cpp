@@ -0,0 +1,77 @@
+/**
+ * @file test_journal.cpp
+ * Tests for recovering unsaved changes from the crash recovery journal.
+ *
+ * Each session runs on its own thread so that it has fresh state.  A
+ * session that ends without closing its files stands in for one that died.
+ */
+
+#include "journal.h"
+#include "ludwiglib.h"
+#include "quit.h"
+#include "session_fixture.h"
+#include "var.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace {
+
+// Edit file in the current frame, as FE does in an interactive session.
+void edit_file(const std::filesystem::path &file) {
+    REQUIRE(ludwiglib_open(true));
+    ludwig_mode = ludwig_mode_type::ludwig_hardcopy;
+    run("fe'" + file.string() + "'");
+}
+
+} // namespace
+
+TEST_CASE("unsaved changes are recovered from the journal", "[journal]") {
+    auto dir = std::filesystem::temp_directory_path() / "ludwig_test_journal";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    auto file = dir / "text.txt";
+    auto journal = dir / ("text.txt" + std::string(JOURNAL_SUFFIX));
+    std::ofstream(file) << "one\ntwo\nthree\n";
+
+    in_new_session([&]() {
+        edit_file(file);
+        run("a k");
+        journal_commit();
+        run("i/new /");
+        journal_commit();
+        run("2l");
+        // This command dies before it is committed.
+    });
+    REQUIRE(std::filesystem::exists(journal));
+    // And so does a write of another.
+    std::ofstream(journal, std::ios::app) << "T\x01";
+
+    in_new_session([&]() {
+        edit_file(file);
+        REQUIRE(ludwiglib_get_text() == "one\nnew three\n");
+        REQUIRE(current_frame->text_modified);
+        run("3j i/ end/");
+        journal_commit();
+        quit_close_files();
+    });
+    REQUIRE_FALSE(std::filesystem::exists(journal));
+    REQUIRE(contents(file) == "one end\nnew three\n");
+
+    // A journal for an older version of the file is ignored.
+    in_new_session([&]() {
+        edit_file(file);
+        run("a k");
+        journal_commit();
+    });
+    std::ofstream(file, std::ios::app) << "changed\n";
+    in_new_session([&]() {
+        edit_file(file);
+        REQUIRE(ludwiglib_get_text() == "one end\nnew three\nchanged\n");
+        quit_close_files();
+    });
+    REQUIRE_FALSE(std::filesystem::exists(journal));
+    std::filesystem::remove_all(dir);
+}
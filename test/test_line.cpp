@@ -0,0 +1,174 @@
+/**
+ * @file test_line.cpp
+ * Tests for moving blocks of lines between and within frames.
+ */
+
+#include "line.h"
+#include "ludwiglib.h"
+#include "mark.h"
+#include "session_fixture.h"
+#include "text.h"
+#include "var.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+namespace {
+
+std::string numbered_lines(int first, int last) {
+    std::string text;
+    for (int i = first; i <= last; ++i)
+        text += "line " + std::to_string(i) + "\n";
+    return text;
+}
+
+line_ptr line_at(frame_ptr frame, line_range line_nr) {
+    line_ptr line;
+    REQUIRE(line_from_number(frame, line_nr, line));
+    REQUIRE(line != nullptr);
+    return line;
+}
+
+// Check the groups of frame agree with its lines, and return its text.
+std::string checked_text(frame_ptr frame) {
+    std::string text;
+    line_range line_nr = 1;
+    const_line_ptr prev_line = nullptr;
+    const_group_ptr prev_group = nullptr;
+    for (const_group_ptr group = frame->first_group; group != nullptr; group = group->flink) {
+        REQUIRE(group->blink == prev_group);
+        REQUIRE(group->frame == frame);
+        REQUIRE(group->first_line_nr == line_nr);
+        REQUIRE(group->nr_lines > 0);
+        const_line_ptr line = group->first_line;
+        for (int offset = 0; offset < group->nr_lines; ++offset, line = line->flink) {
+            REQUIRE(line->blink == prev_line);
+            REQUIRE(line->group == group);
+            REQUIRE(line->offset_nr == offset);
+            if (line->flink != nullptr && line->used > 0)
+                text += std::string(line->str->slice(1, line->used));
+            if (line->flink != nullptr)
+                text += "\n";
+            prev_line = line;
+        }
+        REQUIRE(group->last_line == prev_line);
+        line_nr += group->nr_lines;
+        prev_group = group;
+    }
+    REQUIRE(frame->last_group == prev_group);
+    REQUIRE(prev_line->flink == nullptr);
+    return text;
+}
+
+} // namespace
+
+TEST_CASE("transferred lines keep their order", "[line]") {
+    in_new_session([]() {
+        REQUIRE(ludwiglib_open(true));
+        REQUIRE(ludwiglib_set_text(numbered_lines(1, 500)));
+        frame_ptr frame = current_frame;
+        mark_ptr one = nullptr;
+        mark_ptr two = nullptr;
+        mark_ptr dst = nullptr;
+        mark_ptr new_start = nullptr;
+        mark_ptr new_end = nullptr;
+
+        // Forwards, from inside one line to inside another.
+        REQUIRE(mark_create(line_at(frame, 5), 3, one));
+        REQUIRE(mark_create(line_at(frame, 400), 2, two));
+        REQUIRE(mark_create(line_at(frame, 450), 4, dst));
+        REQUIRE(text_move(false, 1, one, two, dst, new_start, new_end));
+        std::string moved = "ne 5\n" + numbered_lines(6, 399) + "l";
+        std::string expected = numbered_lines(1, 4) + "liine 400\n" + numbered_lines(401, 449) +
+                               "lin" + moved + "e 450\n" + numbered_lines(451, 500);
+        REQUIRE(checked_text(frame) == expected);
+
+        // And back again, to the start of the frame.
+        REQUIRE(mark_create(line_at(frame, 1), 1, dst));
+        REQUIRE(text_move(false, 1, new_start, new_end, dst, one, two));
+        expected = moved + numbered_lines(1, 4) + "liine 400\n" + numbered_lines(401, 449) +
+                   "line 450\n" + numbered_lines(451, 500);
+        REQUIRE(checked_text(frame) == expected);
+
+        // To another frame.
+        frame_ptr oops = frame_oops;
+        REQUIRE(mark_create(line_at(frame, 2), 1, one));
+        REQUIRE(mark_create(line_at(frame, 302), 1, two));
+        REQUIRE(mark_create(oops->last_group->last_line, 1, dst));
+        REQUIRE(text_move(false, 1, one, two, dst, new_start, new_end));
+        REQUIRE(checked_text(oops) == numbered_lines(6, 305));
+        REQUIRE(
+            checked_text(frame) == "ne 5\n" + numbered_lines(306, 399) + "lline 1\n" +
+                                       numbered_lines(2, 4) + "liine 400\n" +
+                                       numbered_lines(401, 449) + "line 450\n" +
+                                       numbered_lines(451, 500)
+        );
+        REQUIRE(mark_destroy(one));
+        REQUIRE(mark_destroy(two));
+        REQUIRE(mark_destroy(dst));
+        REQUIRE(mark_destroy(new_start));
+        REQUIRE(mark_destroy(new_end));
+    });
+}
+
+TEST_CASE("killed lines are moved to the oops frame", "[line]") {
+    in_new_session([]() {
+        REQUIRE(ludwiglib_open(true));
+        REQUIRE(ludwiglib_set_text(numbered_lines(1, 1000)));
+        run("99a 700k");
+        REQUIRE(checked_text(current_frame) == numbered_lines(1, 99) + numbered_lines(800, 1000));
+        REQUIRE(checked_text(frame_oops) == numbered_lines(100, 799));
+        REQUIRE(current_frame->dot->line == line_at(current_frame, 100));
+        run("2a 10k");
+        REQUIRE(checked_text(frame_oops) == numbered_lines(100, 799) + numbered_lines(802, 811));
+    });
+}
+
+TEST_CASE("copied lines share their text until changed", "[line]") {
+    in_new_session([]() {
+        REQUIRE(ludwiglib_open(true));
+        REQUIRE(ludwiglib_set_text(numbered_lines(1, 10)));
+        frame_ptr frame = current_frame;
+        mark_ptr one = nullptr;
+        mark_ptr two = nullptr;
+        mark_ptr dst = nullptr;
+        mark_ptr new_start = nullptr;
+        mark_ptr new_end = nullptr;
+
+        // Two copies of lines 2 to 4 at the end of the frame.
+        REQUIRE(mark_create(line_at(frame, 2), 1, one));
+        REQUIRE(mark_create(line_at(frame, 5), 1, two));
+        REQUIRE(mark_create(frame->last_group->last_line, 1, dst));
+        REQUIRE(text_move(true, 2, one, two, dst, new_start, new_end));
+        std::string copies = numbered_lines(2, 4) + numbered_lines(2, 4);
+        REQUIRE(checked_text(frame) == numbered_lines(1, 10) + copies);
+        line_ptr source = line_at(frame, 3);
+        REQUIRE(line_at(frame, 12)->str == source->str);
+        REQUIRE(line_at(frame, 15)->str == source->str);
+
+        // Changing a copy leaves the source and the other copy alone.
+        REQUIRE(mark_create(line_at(frame, 12), 1, dst));
+        REQUIRE(text_insert(true, 1, str_object('X'), 1, dst));
+        REQUIRE(line_at(frame, 12)->str != source->str);
+        REQUIRE(line_at(frame, 15)->str == source->str);
+        REQUIRE(
+            checked_text(frame) == numbered_lines(1, 10) + numbered_lines(2, 2) + "Xline 3\n" +
+                                       numbered_lines(4, 4) + copies.substr(copies.size() / 2)
+        );
+
+        // The last copy keeps the text when the source goes.
+        REQUIRE(mark_create(source, 1, frame->dot));
+        run("k");
+        REQUIRE(line_at(frame, 14)->str != nullptr);
+        REQUIRE(
+            checked_text(frame) == numbered_lines(1, 2) + numbered_lines(4, 10) +
+                                       numbered_lines(2, 2) + "Xline 3\n" + numbered_lines(4, 4) +
+                                       copies.substr(copies.size() / 2)
+        );
+        REQUIRE(mark_destroy(one));
+        REQUIRE(mark_destroy(two));
+        REQUIRE(mark_destroy(dst));
+        REQUIRE(mark_destroy(new_start));
+        REQUIRE(mark_destroy(new_end));
+    });
+}
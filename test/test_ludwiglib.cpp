@@ -0,0 +1,85 @@
+/**
+ * @file test_ludwiglib.cpp
+ * Tests for the embedding interface.
+ */
+
+#include "ludwiglib.h"
+#include "session_fixture.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <vector>
+
+TEST_CASE("text round trips through a frame", "[ludwiglib]") {
+    auto text = in_new_session([]() {
+        REQUIRE(ludwiglib_open(true));
+        REQUIRE(ludwiglib_set_text("first line\n\nthird line\n"));
+        return ludwiglib_get_text();
+    });
+    REQUIRE(text == "first line\n\nthird line\n");
+}
+
+TEST_CASE("a session is only opened once", "[ludwiglib]") {
+    auto text = in_new_session([]() {
+        REQUIRE(ludwiglib_open(true));
+        REQUIRE(ludwiglib_set_text("kept\n"));
+        REQUIRE_FALSE(ludwiglib_open(true));
+        return ludwiglib_get_text();
+    });
+    REQUIRE(text == "kept\n");
+}
+
+TEST_CASE("missing final newline is supplied", "[ludwiglib]") {
+    auto text = in_new_session([]() {
+        REQUIRE(ludwiglib_open(true));
+        REQUIRE(ludwiglib_set_text("no newline"));
+        return ludwiglib_get_text();
+    });
+    REQUIRE(text == "no newline\n");
+}
+
+TEST_CASE("long lines are split", "[ludwiglib]") {
+    const std::string long_line(MAX_STRLEN + 10, 'x');
+    auto text = in_new_session([&]() {
+        REQUIRE(ludwiglib_open(true));
+        REQUIRE(ludwiglib_set_text(long_line));
+        return ludwiglib_get_text();
+    });
+    REQUIRE(text == std::string(MAX_STRLEN, 'x') + "\n" + std::string(10, 'x') + "\n");
+}
+
+TEST_CASE("transform applies commands to text", "[ludwiglib]") {
+    std::string result;
+    bool ok = in_new_session([&]() {
+        REQUIRE(ludwiglib_open(true));
+        return ludwiglib_transform(">r/foo/baz/", "foo one\nbar foo\nfoo\n", result);
+    });
+    REQUIRE(ok);
+    REQUIRE(result == "baz one\nbar baz\nbaz\n");
+}
+
+TEST_CASE("compiled code can be reused across buffers", "[ludwiglib]") {
+    auto results = in_new_session([]() {
+        REQUIRE(ludwiglib_open(true));
+        code_ptr code = ludwiglib_compile("i/> /");
+        REQUIRE(code != nullptr);
+        std::vector<std::string> texts;
+        for (const char *text : {"one\n", "two\n", "three\n"}) {
+            REQUIRE(ludwiglib_set_text(text));
+            REQUIRE(ludwiglib_run(code));
+            texts.push_back(ludwiglib_get_text());
+        }
+        ludwiglib_discard(code);
+        REQUIRE(code == nullptr);
+        return texts;
+    });
+    REQUIRE(results == std::vector<std::string>{"> one\n", "> two\n", "> three\n"});
+}
+
+TEST_CASE("syntax errors are reported", "[ludwiglib]") {
+    auto code = in_new_session([]() {
+        REQUIRE(ludwiglib_open(true));
+        return ludwiglib_compile("(i/unbalanced/");
+    });
+    REQUIRE(code == nullptr);
+}
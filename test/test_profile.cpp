@@ -0,0 +1,125 @@
+/**
+ * @file test_profile.cpp
+ * Tests for the interpreter profiler.
+ *
+ * Profiling state is per thread, so each test runs on its own thread to
+ * avoid leaving profiling enabled for the other tests.
+ */
+
+#include "profile.h"
+#include "session_fixture.h"
+#include "sys.h"
+#include "value.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+TEST_CASE("profile records nothing unless enabled", "[profile]") {
+    bool enabled = in_new_session([]() {
+        { profile_scope scope(commands::cmd_advance); }
+        return profile_enabled;
+    });
+    REQUIRE_FALSE(enabled);
+}
+
+TEST_CASE("profile report lists commands and spans", "[profile]") {
+    const std::string report = "test_profile_report.txt";
+    bool ok = in_new_session([&]() {
+        value_initializations();
+        load_command_table(true);
+        profile_enable(report);
+        for (int i = 0; i < 3; ++i) {
+            profile_scope scope(commands::cmd_advance);
+        }
+        {
+            profile_scope span_scope(std::string("MYSPAN"));
+            profile_scope scope(commands::cmd_case_up);
+        }
+        return profile_report();
+    });
+    REQUIRE(ok);
+
+    std::string text = contents(report);
+    std::remove(report.c_str());
+
+    SECTION("commands are named by the keys that invoke them") {
+        REQUIRE(text.find("\nA ") != std::string::npos);
+        REQUIRE(text.find("\n*U ") != std::string::npos);
+    }
+
+    SECTION("call counts are recorded") {
+        auto line_start = text.find("\nA ");
+        auto line_end = text.find('\n', line_start + 1);
+        std::istringstream line(text.substr(line_start, line_end - line_start));
+        std::string name;
+        size_t calls;
+        line >> name >> calls;
+        REQUIRE(calls == 3);
+    }
+
+    SECTION("spans are reported") {
+        REQUIRE(text.find("Spans") != std::string::npos);
+        REQUIRE(text.find("MYSPAN") != std::string::npos);
+    }
+}
+
+TEST_CASE("profile report adds up the counts of batch workers", "[profile]") {
+    const std::string report = "test_profile_workers.txt";
+    bool ok = in_new_session([&]() {
+        value_initializations();
+        load_command_table(true);
+        profile_enable(report);
+        { profile_scope scope(commands::cmd_advance); }
+        for (size_t worker = 0; worker < 2; ++worker) {
+            long pid = sys_fork_worker();
+            if (pid < 0)
+                return false;
+            if (pid == 0) {
+                profile_worker(worker);
+                for (size_t i = 0; i <= worker; ++i) {
+                    profile_scope span_scope(std::string("MY SPAN"));
+                    profile_scope scope(commands::cmd_advance);
+                }
+                ::_exit(profile_report() ? 0 : 1);
+            }
+        }
+        bool success = true;
+        bool worker_success;
+        for (int i = 0; i < 2; ++i)
+            success = sys_wait_worker(worker_success) > 0 && worker_success && success;
+        success = profile_merge(0) && profile_merge(1) && success;
+        return profile_report() && success;
+    });
+    REQUIRE(ok);
+
+    std::string text = contents(report);
+    std::remove(report.c_str());
+    REQUIRE(contents(report + ".0").empty());
+
+    auto calls = [&text](const std::string &name) {
+        auto line_start = text.find("\n" + name + " ");
+        if (line_start == std::string::npos)
+            return size_t(0);
+        std::istringstream line(text.substr(line_start + name.size() + 1));
+        size_t count;
+        line >> count;
+        return count;
+    };
+    REQUIRE(calls("A") == 4);
+    REQUIRE(calls("MY SPAN") == 3);
+}
+
+TEST_CASE("profile merge rejects a damaged worker file", "[profile]") {
+    const std::string report = "test_profile_damaged.txt";
+    bool merged = in_new_session([&]() {
+        profile_enable(report);
+        std::ofstream(report + ".0") << "\nC\n";
+        return profile_merge(0);
+    });
+    REQUIRE_FALSE(merged);
+    REQUIRE(contents(report + ".0").empty());
+}
@@ -0,0 +1,162 @@
+/**
+ * @file test_screen.cpp
+ * Tests for the screen routines, run on the recording vdu backend.
+ */
+
+#include "exec.h"
+#include "ludwiglib.h"
+#include "mark.h"
+#include "screen.h"
+#include "session.h"
+#include "session_fixture.h"
+#include "value.h"
+#include "var.h"
+#include "vdu.h"
+#include "vdu_record.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <functional>
+#include <string>
+
+namespace {
+
+/**
+ * Run body in a new screen mode session displaying some text on term.
+ */
+void in_screen_session(
+    vdu_recorder &term, const std::function<void()> &body, bool status_line = false
+) {
+    in_new_session([&]() {
+        session_initialize();
+        load_command_table(true);
+        if (status_line)
+            vdu_reserve_status_line();
+        vdu_init_backend(term, terminal_info, tt_controlc, tt_winchanged);
+        initial_scr_width = terminal_info.width;
+        initial_scr_height = terminal_info.height;
+        initial_margin_right = terminal_info.width;
+        ludwig_mode = ludwig_mode_type::ludwig_screen;
+        scr_msg_row = terminal_info.height + 1;
+        REQUIRE(session_create_frames());
+        std::string text;
+        for (int i = 1; i <= 100; ++i)
+            text += "line " + std::to_string(i) + "\n";
+        REQUIRE(ludwiglib_set_text(text));
+        screen_fixup();
+        vdu_flush();
+        body();
+        vdu_free();
+        session_close();
+    });
+}
+
+} // namespace
+
+TEST_CASE("resize events are handled once the last one has arrived", "[screen]") {
+    vdu_recorder term(40, 10, false);
+    in_screen_session(term, [&]() {
+        REQUIRE(term.screen().row_text(1).starts_with("line 1 "));
+        term.resize(50, 12);
+        REQUIRE(execute(commands::cmd_resize_window, leadparam::none, 1, nullptr, false));
+        REQUIRE(tt_winchanged);
+        REQUIRE(terminal_info.width == 40);
+
+        // Another resize event is waiting, so the command loop does nothing
+        // yet.
+        term.resize(60, 15);
+        term.push_key(-1);
+        REQUIRE(screen_type_ahead());
+        REQUIRE(terminal_info.width == 40);
+
+        REQUIRE(vdu_get_key() == -1);
+        REQUIRE(execute(commands::cmd_resize_window, leadparam::none, 1, nullptr, false));
+        screen_fixup();
+        vdu_flush();
+        REQUIRE_FALSE(tt_winchanged);
+        REQUIRE(terminal_info.width == 60);
+        REQUIRE(terminal_info.height == 15);
+        REQUIRE(current_frame->scr_height == 15);
+        REQUIRE(term.screen().row_text(1).starts_with("line 1 "));
+        REQUIRE(term.screen().row_text(15).starts_with("line 15 "));
+    });
+}
+
+TEST_CASE("the status line is only rewritten when it changes", "[screen]") {
+    vdu_recorder term(40, 10, false);
+    in_screen_session(
+        term,
+        [&]() {
+            REQUIRE(terminal_info.height == 9);
+            REQUIRE(term.screen().row_text(10).starts_with(" LUDWIG  Line 1  Col 1 "));
+
+            term.reset();
+            screen_fixup();
+            vdu_flush();
+            REQUIRE(term.bytes() == 0);
+
+            line_ptr line = current_frame->dot->line->flink->flink;
+            REQUIRE(mark_create(line, 4, current_frame->dot));
+            screen_fixup();
+            vdu_flush();
+            REQUIRE(term.screen().row_text(10).starts_with(" LUDWIG  Line 3  Col 4 "));
+            REQUIRE(term.screen().row_text(9).starts_with("line 9 "));
+        },
+        true
+    );
+}
+
+TEST_CASE("viewports are kept below the current frame", "[screen]") {
+    vdu_recorder term(40, 10, false);
+    in_screen_session(term, [&]() {
+        current_frame->options.insert(frame_options_elts::opt_viewport);
+        screen_fixup();
+        vdu_flush();
+        REQUIRE(terminal_info.height == 5);
+        REQUIRE(term.screen().row_text(1).starts_with("line 1 "));
+        REQUIRE(term.screen().row_text(6).starts_with("-- LUDWIG ---"));
+        REQUIRE(term.screen().row_text(7).starts_with("line 1 "));
+        REQUIRE(term.screen().row_text(10).starts_with("line 4 "));
+
+        term.reset();
+        screen_fixup();
+        vdu_flush();
+        REQUIRE(term.bytes() == 0);
+
+        // The current frame scrolls within its own rows.
+        line_ptr line = current_frame->dot->line;
+        for (int i = 1; i < 20; ++i)
+            line = line->flink;
+        REQUIRE(mark_create(line, 1, current_frame->dot));
+        screen_fixup();
+        vdu_flush();
+        REQUIRE(term.screen().row_text(6).starts_with("-- LUDWIG ---"));
+        REQUIRE(term.screen().row_text(7).starts_with("line 17 "));
+        REQUIRE(term.screen().row_text(10).starts_with("line 20 "));
+        REQUIRE(current_frame->dot->line->scr_row_nr <= 5);
+
+        current_frame->options.erase(frame_options_elts::opt_viewport);
+        screen_fixup();
+        vdu_flush();
+        REQUIRE(terminal_info.height == 10);
+        REQUIRE(term.screen().row_text(10).starts_with("line "));
+    });
+}
+
+TEST_CASE("fixup shows the dot even when a command is typed ahead", "[screen]") {
+    vdu_recorder term(40, 10, false);
+    in_screen_session(term, [&]() {
+        line_ptr line = current_frame->dot->line;
+        for (int i = 1; i < 50; ++i)
+            line = line->flink;
+        REQUIRE(mark_create(line, 1, current_frame->dot));
+        term.push_key(1);
+        REQUIRE(screen_type_ahead());
+        screen_fixup();
+        vdu_flush();
+        REQUIRE(current_frame->dot->line->scr_row_nr != 0);
+        REQUIRE(
+            term.screen().row_text(current_frame->dot->line->scr_row_nr).starts_with("line 50 ")
+        );
+        REQUIRE(vdu_get_key() == 1);
+    });
+}
@@ -0,0 +1,115 @@
+/**
+ * @file test_session.cpp
+ * Tests for independent editing sessions on separate threads.
+ */
+
+#include "line.h"
+#include "ludwiglib.h"
+#include "session.h"
+#include "session_fixture.h"
+#include "text.h"
+#include "type.h"
+#include "var.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * Insert a thousand lines of text at the dot of the current frame and
+ * return the non-empty lines of the resulting frame.
+ */
+bool insert_and_collect(const std::string &text, std::vector<std::string> &result) {
+    str_object buf(' ');
+    buf.copy_n(text.data(), text.size());
+    for (int i = 0; i < 1000; ++i) {
+        if (!text_insert(false, 1, buf, text.size(), current_frame->dot))
+            return false;
+        mark_ptr equals;
+        if (!text_split_line(current_frame->dot, 0, equals))
+            return false;
+    }
+    for (line_ptr line = current_frame->first_group->first_line; line->flink != nullptr;
+         line = line->flink) {
+        if (line->used > 0)
+            result.emplace_back(line->str->slice(1, line->used));
+    }
+    return true;
+}
+
+} // namespace
+
+TEST_CASE("sessions run independently on separate threads", "[session]") {
+    struct outcome {
+        frame_ptr frame_a = nullptr;
+        frame_ptr frame_b = nullptr;
+        std::vector<std::string> lines_a;
+        std::vector<std::string> lines_b;
+        bool main_frame_kept = false;
+        bool main_span_kept = false;
+        std::string main_text;
+    };
+
+    outcome result = in_new_session([]() {
+        outcome result;
+        REQUIRE(session_open_batch(true));
+        REQUIRE(ludwiglib_set_text("main\n"));
+        const frame_ptr main_frame = current_frame;
+        const span_ptr main_span = first_span;
+
+        auto session_a = session_start([&]() {
+            result.frame_a = current_frame;
+            return insert_and_collect("alpha", result.lines_a);
+        });
+        auto session_b = session_start([&]() {
+            result.frame_b = current_frame;
+            return insert_and_collect("beta", result.lines_b);
+        });
+        REQUIRE(session_a.get());
+        REQUIRE(session_b.get());
+
+        result.main_frame_kept = current_frame == main_frame;
+        result.main_span_kept = first_span == main_span;
+        result.main_text = ludwiglib_get_text();
+        session_close();
+        return result;
+    });
+
+    SECTION("each session has its own frames") {
+        REQUIRE(result.frame_a != nullptr);
+        REQUIRE(result.frame_b != nullptr);
+        REQUIRE(result.frame_a != result.frame_b);
+    }
+
+    SECTION("edits in one session are not visible in the other") {
+        REQUIRE(result.lines_a.size() == 1000);
+        REQUIRE(result.lines_b.size() == 1000);
+        for (const auto &line : result.lines_a)
+            REQUIRE(line == "alpha");
+        for (const auto &line : result.lines_b)
+            REQUIRE(line == "beta");
+    }
+
+    SECTION("the calling thread's session is untouched") {
+        REQUIRE(result.main_frame_kept);
+        REQUIRE(result.main_span_kept);
+        REQUIRE(result.main_text == "main\n");
+    }
+}
+
+TEST_CASE("a started session can run commands", "[session]") {
+    std::string text;
+    auto session = session_start([&]() {
+        code_ptr code = ludwiglib_compile("i/one/");
+        if (code == nullptr)
+            return false;
+        bool ok = ludwiglib_run(code);
+        ludwiglib_discard(code);
+        text = ludwiglib_get_text();
+        return ok;
+    });
+    REQUIRE(session.get());
+    REQUIRE(text == "one\n");
+}
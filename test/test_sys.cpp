@@ -0,0 +1,84 @@
+/**
+ * @file test_sys.cpp
+ * Tests for the operating system support routines.
+ */
+
+#include "sys.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+TEST_CASE("backup versions follow changes to the directory", "[sys]") {
+    auto dir = std::filesystem::temp_directory_path() / "ludwig_test_sys";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const std::string file = (dir / "text.txt").string();
+    const std::string backup = file + "~";
+    for (auto name : {"text.txt", "text.txt~1", "text.txt~3", "text.txt~x", "other~2"})
+        std::ofstream(dir / name) << "x\n";
+
+    REQUIRE(sys_list_backups(backup) == std::vector<long>{1, 3});
+
+    // Our own changes are seen whether or not they alter the modification
+    // time of the directory.
+    REQUIRE(sys_unlink(backup + "1"));
+    REQUIRE(sys_list_backups(backup) == std::vector<long>{3});
+    REQUIRE(sys_rename(file, backup + "4"));
+    REQUIRE(sys_list_backups(backup) == std::vector<long>{3, 4});
+    int fd = sys_create_file(backup + "9");
+    REQUIRE(fd >= 0);
+    sys_close(fd);
+    REQUIRE(sys_list_backups(backup) == std::vector<long>{3, 4, 9});
+
+    // So are changes made by anyone else.  The directory's time is set by
+    // hand, so as not to depend on how finely the filesystem keeps it.
+    auto mtime = std::filesystem::last_write_time(dir);
+    std::filesystem::remove(dir / "text.txt~3");
+    std::ofstream(dir / "text.txt~7") << "x\n";
+    std::filesystem::last_write_time(dir, mtime - std::chrono::hours(1));
+    REQUIRE(sys_list_backups(backup) == std::vector<long>{4, 7, 9});
+
+    // Even within the same tick of the directory's clock, a new last
+    // version is seen, so the next backup can't replace it.
+    mtime = std::filesystem::last_write_time(dir);
+    std::ofstream(dir / "text.txt~10") << "x\n";
+    std::filesystem::last_write_time(dir, mtime);
+    REQUIRE(sys_list_backups(backup) == std::vector<long>{4, 7, 9, 10});
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("waiting for workers leaves other children alone", "[sys]") {
+    pid_t other = ::fork();
+    REQUIRE(other >= 0);
+    if (other == 0)
+        ::_exit(0);
+    long failed = sys_fork_worker();
+    REQUIRE(failed >= 0);
+    if (failed == 0)
+        ::_exit(1);
+    long worker = sys_fork_worker();
+    REQUIRE(worker >= 0);
+    if (worker == 0)
+        ::_exit(0);
+
+    bool success;
+    long first = sys_wait_worker(success);
+    REQUIRE((first == failed || first == worker));
+    REQUIRE(success == (first == worker));
+    long second = sys_wait_worker(success);
+    REQUIRE(second == (first == worker ? failed : worker));
+    REQUIRE(success == (second == worker));
+    REQUIRE(sys_wait_worker(success) == -1);
+    REQUIRE_FALSE(success);
+
+    // The other child is still there to be waited for.
+    int pstat;
+    REQUIRE(::waitpid(other, &pstat, 0) == other);
+}
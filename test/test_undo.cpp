@@ -0,0 +1,140 @@
+/**
+ * @file test_undo.cpp
+ * Tests for undoing and redoing changes to a frame.
+ */
+
+#include "ludwiglib.h"
+#include "quit.h"
+#include "session_fixture.h"
+#include "undo.h"
+#include "var.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+
+namespace {
+
+// Run commands as one command of an interactive session.
+bool command(std::string_view commands) {
+    undo_begin_command();
+    code_ptr code = ludwiglib_compile(commands);
+    REQUIRE(code != nullptr);
+    bool result = ludwiglib_run(code);
+    ludwiglib_discard(code);
+    return result;
+}
+
+} // namespace
+
+TEST_CASE("changes are undone and redone a command at a time", "[undo]") {
+    in_new_session([]() {
+        REQUIRE(ludwiglib_open(true));
+        REQUIRE(ludwiglib_set_text("one\ntwo\nthree\n"));
+        REQUIRE_FALSE(command("uu"));
+
+        REQUIRE(command("a k"));
+        REQUIRE(command("i/new /"));
+        REQUIRE(command("2l i/added/"));
+        REQUIRE(ludwiglib_get_text() == "one\n    added\n\nnew three\n");
+
+        REQUIRE(command("uu"));
+        REQUIRE(ludwiglib_get_text() == "one\nnew three\n");
+        REQUIRE(current_frame->dot->col == 5);
+        REQUIRE(command("2uu"));
+        REQUIRE(ludwiglib_get_text() == "one\ntwo\nthree\n");
+        REQUIRE(current_frame->dot->line == current_frame->first_group->first_line);
+        REQUIRE_FALSE(command("uu"));
+
+        REQUIRE(command("-2uu"));
+        REQUIRE(ludwiglib_get_text() == "one\nnew three\n");
+        REQUIRE(command("-uu"));
+        REQUIRE(ludwiglib_get_text() == "one\n    added\n\nnew three\n");
+        REQUIRE_FALSE(command("-uu"));
+
+        // A new change can't be followed by a redo.
+        REQUIRE(command("uu"));
+        REQUIRE(command("i/x/"));
+        REQUIRE_FALSE(command("-uu"));
+        REQUIRE(command("uu"));
+        REQUIRE(ludwiglib_get_text() == "one\nnew three\n");
+    });
+}
+
+TEST_CASE("line splits and joins are undone", "[undo]") {
+    in_new_session([]() {
+        REQUIRE(ludwiglib_open(true));
+        REQUIRE(ludwiglib_set_text("first line\nsecond line\n"));
+        REQUIRE(command("6j sl"));
+        REQUIRE(ludwiglib_get_text() == "first\nline\nsecond line\n");
+        REQUIRE(command("-a 3j 2d"));
+        REQUIRE(command("m a 2j @1d"));
+        REQUIRE(ludwiglib_get_text() == "firne\nsecond line\n");
+        REQUIRE(command("3uu"));
+        REQUIRE(ludwiglib_get_text() == "first line\nsecond line\n");
+        REQUIRE(command("-3uu"));
+        REQUIRE(ludwiglib_get_text() == "firne\nsecond line\n");
+        REQUIRE(command("3uu"));
+        REQUIRE(ludwiglib_get_text() == "first line\nsecond line\n");
+    });
+}
+
+TEST_CASE("changes that don't fit the space limit are forgotten", "[undo]") {
+    in_new_session([]() {
+        REQUIRE(ludwiglib_open(true));
+        std::string text;
+        for (int i = 1; i <= 30; ++i)
+            text += std::string(60, 'x') + "\n";
+        REQUIRE(ludwiglib_set_text(text));
+        current_frame->space_limit = 1000;
+        REQUIRE(command("i/a/"));
+        REQUIRE(command(">k"));
+        REQUIRE(ludwiglib_get_text().empty());
+        REQUIRE_FALSE(command("uu"));
+        REQUIRE(command("i/b/"));
+        REQUIRE(command("uu"));
+        REQUIRE(ludwiglib_get_text().empty());
+    });
+}
+
+TEST_CASE("reading and paging a file are not undone", "[undo]") {
+    auto dir = std::filesystem::temp_directory_path() / "ludwig_test_undo";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    auto file = dir / "text.txt";
+    std::ofstream(file) << "one\ntwo\nthree\n";
+    std::string edit = "fe'" + file.string() + "'";
+
+    in_new_session([&]() {
+        REQUIRE(ludwiglib_open(true));
+        REQUIRE(command(edit));
+        REQUIRE_FALSE(command("uu"));
+        REQUIRE(command("i/x/"));
+        REQUIRE(command("uu"));
+        REQUIRE_FALSE(command("uu"));
+        REQUIRE(ludwiglib_get_text() == "one\ntwo\nthree\n");
+        REQUIRE(command("i/y/"));
+        quit_close_files();
+    });
+    REQUIRE(contents(file) == "yone\ntwo\nthree\n");
+
+    // Lines paged out are written to the output, and the changes made to
+    // them are forgotten.
+    in_new_session([&]() {
+        REQUIRE(ludwiglib_open(true));
+        REQUIRE(command(edit));
+        REQUIRE(command("i/x/"));
+        REQUIRE(command("2a fp"));
+        REQUIRE(ludwiglib_get_text() == "three\n");
+        REQUIRE_FALSE(command("uu"));
+        REQUIRE(command("i/z/"));
+        REQUIRE(command("uu"));
+        REQUIRE_FALSE(command("uu"));
+        REQUIRE(command("i/w/"));
+        quit_close_files();
+    });
+    REQUIRE(contents(file) == "xyone\ntwo\nwthree\n");
+    std::filesystem::remove_all(dir);
+}
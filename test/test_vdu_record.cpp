@@ -0,0 +1,107 @@
+/**
+ * @file test_vdu_record.cpp
+ * Tests for running the vdu routines on the recording backend.
+ */
+
+#include "vdu.h"
+#include "vdu_record.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace {
+
+class slow_recorder : public vdu_recorder {
+public:
+    slow_recorder() : vdu_recorder(40, 10, false) {}
+
+    void update() override {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        vdu_recorder::update();
+    }
+};
+
+} // namespace
+
+TEST_CASE("vdu output goes to the installed backend", "[vdu]") {
+    vdu_recorder term(40, 10, true);
+    terminal_info_type info;
+    bool ctrl_c = false;
+    bool winchange = false;
+    vdu_init_backend(term, info, ctrl_c, winchange);
+    REQUIRE(info.width == 40);
+    REQUIRE(info.height == 10);
+
+    SECTION("output is only sent when flushed") {
+        unsigned long refreshes = vdu_refresh_count();
+        term.reset();
+        vdu_movecurs(5, 3);
+        vdu_displaystr("hello", 0);
+        REQUIRE(term.bytes() == 0);
+        vdu_flush();
+        REQUIRE(term.bytes() > 0);
+        REQUIRE(term.output().find("hello") != std::string::npos);
+        REQUIRE(term.screen().row_text(3).substr(4, 5) == "hello");
+        REQUIRE(vdu_refresh_count() == refreshes + 1);
+
+        vdu_flush();
+        REQUIRE(vdu_refresh_count() == refreshes + 1);
+    }
+
+    SECTION("keys come from the queue") {
+        term.push_key('a');
+        term.push_key('b');
+        key_code_range key;
+        REQUIRE(vdu_key_pending(key));
+        REQUIRE(key == 'a');
+        REQUIRE(vdu_get_key() == 'a');
+        vdu_take_back_key('z');
+        REQUIRE(vdu_get_key() == 'z');
+        REQUIRE(vdu_get_key() == 'b');
+        REQUIRE_FALSE(vdu_key_pending(key));
+    }
+
+    SECTION("resizing reports the new size") {
+        term.resize(60, 20);
+        scr_col_range width;
+        scr_row_range height;
+        vdu_get_new_dimensions(width, height);
+        REQUIRE(width == 60);
+        REQUIRE(height == 20);
+    }
+
+    vdu_free();
+}
+
+TEST_CASE("adaptive progress updates are skipped while the terminal is busy", "[vdu]") {
+    slow_recorder term;
+    terminal_info_type info;
+    bool ctrl_c = false;
+    bool winchange = false;
+    vdu_init_backend(term, info, ctrl_c, winchange);
+    term.reset();
+
+    SECTION("not adaptive") {
+        for (int i = 0; i < 5; ++i) {
+            vdu_movecurs(1, 1);
+            vdu_displaystr(std::to_string(i), 0);
+            vdu_flush_progress(false);
+        }
+        REQUIRE(term.updates() == 5);
+    }
+
+    SECTION("adaptive") {
+        for (int i = 0; i < 5; ++i) {
+            vdu_movecurs(1, 1);
+            vdu_displaystr(std::to_string(i), 0);
+            vdu_flush_progress(true);
+        }
+        REQUIRE(term.updates() < 5);
+        vdu_flush();
+        REQUIRE(term.screen().row_text(1).starts_with("4"));
+    }
+
+    vdu_free();
+}
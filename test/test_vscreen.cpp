@@ -0,0 +1,284 @@
+/**
+ * @file test_vscreen.cpp
+ * Tests for the virtual screen model and its rendering.
+ *
+ * The output of render() is played back into a tiny terminal emulator that
+ * understands just the sequences vscreen uses, and the result is compared
+ * with what the screen should show.
+ */
+
+#include "vscreen.h"
+
+#include <algorithm>
+#include <catch2/catch_test_macros.hpp>
+#include <cctype>
+#include <string>
+#include <vector>
+
+namespace {
+
+class fake_terminal {
+public:
+    fake_terminal(int width, int height)
+        : width(width), height(height), lines(height, std::string(width, ' ')) {}
+
+    void play(const std::string &out) {
+        for (size_t i = 0; i < out.size(); ++i) {
+            char ch = out[i];
+            if (ch == '\r') {
+                col = 0;
+            } else if (ch == '\x1b' && i + 1 < out.size() && out[i + 1] == '[') {
+                i += 2;
+                std::vector<int> args{0};
+                while (i < out.size() && (std::isdigit(out[i]) || out[i] == ';')) {
+                    if (out[i] == ';')
+                        args.push_back(0);
+                    else
+                        args.back() = args.back() * 10 + (out[i] - '0');
+                    ++i;
+                }
+                command(out[i], args);
+            } else {
+                if (col < width)
+                    lines[row][col] = ch;
+                col += 1;
+            }
+        }
+    }
+
+    std::string line(int r) const {
+        return lines[r - 1];
+    }
+
+private:
+    void command(char cmd, const std::vector<int> &args) {
+        int n = std::max(args[0], 1);
+        switch (cmd) {
+        case 'H':
+            row = std::max(args[0], 1) - 1;
+            col = (args.size() > 1 ? std::max(args[1], 1) : 1) - 1;
+            break;
+        case 'K':
+            for (int c = col; c < width; ++c)
+                lines[row][c] = ' ';
+            break;
+        case 'J':
+            for (auto &l : lines)
+                l.assign(width, ' ');
+            break;
+        case 'M':
+            lines.erase(lines.begin() + row, lines.begin() + row + n);
+            lines.insert(lines.end(), n, std::string(width, ' '));
+            break;
+        case 'L':
+            lines.erase(lines.end() - n, lines.end());
+            lines.insert(lines.begin() + row, n, std::string(width, ' '));
+            break;
+        case '@':
+            lines[row].insert(col, n, ' ');
+            lines[row].resize(width);
+            break;
+        case 'P':
+            lines[row].erase(col, n);
+            lines[row].append(n, ' ');
+            break;
+        default:
+            break;
+        }
+    }
+
+    int width;
+    int height;
+    int row = 0;
+    int col = 0;
+    std::vector<std::string> lines;
+};
+
+std::string padded(const std::string &s, int width) {
+    return s + std::string(width - s.size(), ' ');
+}
+
+void fill(vscreen &vs, int first_line_nr) {
+    for (int r = 1; r <= vs.height(); ++r) {
+        vs.move(1, r);
+        vs.put("line " + std::to_string(first_line_nr + r - 1));
+        vs.clear_eol();
+    }
+}
+
+} // namespace
+
+TEST_CASE("vscreen renders text written to it", "[vscreen]") {
+    vscreen vs(20, 5);
+    fake_terminal term(20, 5);
+    vs.move(3, 2);
+    vs.put("hello");
+    term.play(vs.render());
+    REQUIRE(term.line(2) == padded("  hello", 20));
+    REQUIRE(term.line(1) == padded("", 20));
+}
+
+TEST_CASE("vscreen sends nothing when nothing has changed", "[vscreen]") {
+    vscreen vs(20, 5);
+    fill(vs, 1);
+    vs.render();
+    fill(vs, 1);
+    REQUIRE(vs.render().empty());
+}
+
+TEST_CASE("vscreen sends only the changed characters", "[vscreen]") {
+    vscreen vs(40, 5);
+    fake_terminal term(40, 5);
+    vs.move(1, 3);
+    vs.put("the quick brown fox jumps over the dog");
+    term.play(vs.render());
+    vs.move(11, 3);
+    vs.put("green");
+    std::string out = vs.render();
+    term.play(out);
+    REQUIRE(term.line(3) == padded("the quick green fox jumps over the dog", 40));
+    REQUIRE(out.size() < 20);
+}
+
+TEST_CASE("vscreen clears the tail of a shortened line", "[vscreen]") {
+    vscreen vs(40, 5);
+    fake_terminal term(40, 5);
+    vs.move(1, 1);
+    vs.put("a long line of text to be shortened");
+    term.play(vs.render());
+    vs.move(7, 1);
+    vs.clear_eol();
+    std::string out = vs.render();
+    term.play(out);
+    REQUIRE(term.line(1) == padded("a long", 40));
+    REQUIRE(out.find("\x1b[K") != std::string::npos);
+}
+
+TEST_CASE("vscreen scrolls rather than redrawing moved rows", "[vscreen]") {
+    const int width = 30;
+    const int height = 20;
+    vscreen vs(width, height);
+    fake_terminal term(width, height);
+    fill(vs, 1);
+    std::string full = vs.render();
+    term.play(full);
+
+    SECTION("forward") {
+        fill(vs, 4);
+        std::string out = vs.render();
+        term.play(out);
+        for (int r = 1; r <= height; ++r)
+            REQUIRE(term.line(r) == padded("line " + std::to_string(r + 3), width));
+        REQUIRE(out.size() < full.size() / 3);
+    }
+
+    SECTION("backward") {
+        fill(vs, -2);
+        std::string out = vs.render();
+        term.play(out);
+        for (int r = 1; r <= height; ++r)
+            REQUIRE(term.line(r) == padded("line " + std::to_string(r - 3), width));
+        REQUIRE(out.size() < full.size() / 3);
+    }
+}
+
+TEST_CASE("vscreen shifts rows sideways rather than redrawing them", "[vscreen]") {
+    const int width = 60;
+    const int height = 10;
+    std::string text;
+    for (int i = 0; text.size() < 200; ++i)
+        text += "word" + std::to_string(i) + ' ';
+    auto draw = [&](vscreen &vs, int offset) {
+        for (int r = 1; r <= height; ++r) {
+            vs.move(1, r);
+            vs.put(std::to_string(r) + text.substr(offset, width - 4));
+            vs.clear_eol();
+        }
+    };
+    vscreen vs(width, height);
+    fake_terminal term(width, height);
+    draw(vs, 30);
+    std::string full = vs.render();
+    term.play(full);
+
+    SECTION("left") {
+        draw(vs, 36);
+        std::string out = vs.render();
+        term.play(out);
+        for (int r = 1; r <= height; ++r)
+            REQUIRE(term.line(r) == vs.row_text(r));
+        REQUIRE(out.size() < full.size() / 2);
+    }
+
+    SECTION("right") {
+        draw(vs, 24);
+        std::string out = vs.render();
+        term.play(out);
+        for (int r = 1; r <= height; ++r)
+            REQUIRE(term.line(r) == vs.row_text(r));
+        REQUIRE(out.size() < full.size() / 2);
+    }
+}
+
+TEST_CASE("vscreen line and character editing", "[vscreen]") {
+    vscreen vs(10, 4);
+    for (int r = 1; r <= 4; ++r) {
+        vs.move(1, r);
+        vs.put(std::string(1, char('a' + r - 1)));
+    }
+
+    SECTION("delete lines") {
+        vs.move(1, 2);
+        vs.delete_lines(2);
+        REQUIRE(vs.row_text(2) == padded("d", 10));
+        REQUIRE(vs.row_text(3) == padded("", 10));
+    }
+
+    SECTION("insert lines") {
+        vs.move(1, 2);
+        vs.insert_lines(1);
+        REQUIRE(vs.row_text(2) == padded("", 10));
+        REQUIRE(vs.row_text(3) == padded("b", 10));
+        REQUIRE(vs.row_text(4) == padded("c", 10));
+    }
+
+    SECTION("insert and delete characters") {
+        vs.move(1, 1);
+        vs.put("abcdef");
+        vs.move(3, 1);
+        vs.insert_chars(2);
+        REQUIRE(vs.row_text(1) == padded("ab  cdef", 10));
+        vs.delete_chars(3);
+        REQUIRE(vs.row_text(1) == padded("abdef", 10));
+    }
+
+    SECTION("line operations stay within the region") {
+        vs.set_region(3);
+        vs.move(1, 1);
+        vs.delete_lines(1);
+        REQUIRE(vs.row_text(3) == padded("", 10));
+        REQUIRE(vs.row_text(4) == padded("d", 10));
+        vs.insert_lines(2);
+        REQUIRE(vs.row_text(3) == padded("b", 10));
+        REQUIRE(vs.row_text(4) == padded("d", 10));
+        vs.clear();
+        REQUIRE(vs.row_text(4) == padded("d", 10));
+    }
+
+    SECTION("text is clipped at the right margin") {
+        vs.move(8, 1);
+        vs.put("wxyz");
+        REQUIRE(vs.row_text(1) == "a      wxy");
+    }
+}
+
+TEST_CASE("vscreen redraws everything after invalidate", "[vscreen]") {
+    vscreen vs(20, 3);
+    fill(vs, 1);
+    vs.render();
+    vs.invalidate();
+    fake_terminal term(20, 3);
+    term.play(vs.render());
+    for (int r = 1; r <= 3; ++r)
+        REQUIRE(term.line(r) == padded("line " + std::to_string(r), 20));
+}
@@ -0,0 +1,147 @@
+/**
+ * @file test_word.cpp
+ * Tests for the word processing commands.
+ */
+
+#include "line.h"
+#include "ludwiglib.h"
+#include "mark.h"
+#include "newword.h"
+#include "session_fixture.h"
+#include "var.h"
+#include "word.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <string>
+
+namespace {
+
+void set_up(const std::string &text, int margin_left, int margin_right, line_range dot_line) {
+    REQUIRE(ludwiglib_open(true));
+    REQUIRE(ludwiglib_set_text(text));
+    current_frame->margin_left = margin_left;
+    current_frame->margin_right = margin_right;
+    line_ptr line;
+    REQUIRE(line_from_number(current_frame, dot_line, line));
+    REQUIRE(mark_create(line, 1, current_frame->dot));
+}
+
+line_range line_nr(const_mark_ptr mark) {
+    return mark->line->group->first_line_nr + mark->line->offset_nr;
+}
+
+} // namespace
+
+TEST_CASE("fill reflows the rest of a paragraph", "[word]") {
+    in_new_session([]() {
+        set_up(
+            "  one two three\nfour five  six seven eight nine\nten\n\nnext paragraph\n", 1, 20, 1
+        );
+        line_ptr line;
+        REQUIRE(line_from_number(current_frame, 2, line));
+        mark_ptr seven = nullptr;
+        REQUIRE(mark_create(line, 17, seven));
+        REQUIRE(word_fill(leadparam::pindef, 1));
+        REQUIRE(
+            ludwiglib_get_text() ==
+            "  one two three four\nfive  six seven\neight nine ten\n\nnext paragraph\n"
+        );
+        REQUIRE(line_nr(seven) == 2);
+        REQUIRE(seven->col == 12);
+        REQUIRE(line_nr(current_frame->dot) == 4);
+        REQUIRE(mark_destroy(seven));
+    });
+}
+
+TEST_CASE("fill with a count only upsets the lines counted", "[word]") {
+    in_new_session([]() {
+        set_up("one two\nthree\nfour five\nsix seven\n", 3, 12, 1);
+        REQUIRE(word_fill(leadparam::none, 1));
+        REQUIRE(ludwiglib_get_text() == "one two\n  three\nfour five\nsix seven\n");
+        REQUIRE(line_nr(current_frame->dot) == 2);
+        REQUIRE(current_frame->dot->col == 3);
+    });
+}
+
+TEST_CASE("fill leaves a line of one character where it is", "[word]") {
+    in_new_session([]() {
+        set_up("cccccccccccccccccccccc    ooooo\n  f\ngg hh\n", 5, 32, 1);
+        REQUIRE(word_fill(leadparam::pindef, 1));
+        REQUIRE(ludwiglib_get_text() == "cccccccccccccccccccccc    ooooo\n  f gg hh\n");
+    });
+}
+
+TEST_CASE("fill leaves marks in the leading spaces alone", "[word]") {
+    in_new_session([]() {
+        set_up("   one two\nthree\n", 1, 20, 1);
+        mark_ptr indent = nullptr;
+        REQUIRE(mark_create(current_frame->dot->line, 2, indent));
+        REQUIRE(word_fill(leadparam::pindef, 1));
+        REQUIRE(ludwiglib_get_text() == "   one two three\n");
+        REQUIRE(line_nr(indent) == 1);
+        REQUIRE(indent->col == 2);
+        REQUIRE(mark_destroy(indent));
+    });
+}
+
+TEST_CASE("fill fails on a word wider than the margins", "[word]") {
+    in_new_session([]() {
+        set_up("short\nabcdefghijklmnop\n", 1, 10, 1);
+        REQUIRE_FALSE(word_fill(leadparam::pindef, 1));
+        REQUIRE(ludwiglib_get_text() == "short\nabcdefghijklmnop\n");
+    });
+}
+
+TEST_CASE("fill that can't finish keeps the lines already filled", "[word]") {
+    in_new_session([]() {
+        set_up("one\ntwo\n  abcdefghijklmnop\nthree\n", 3, 10, 1);
+        REQUIRE_FALSE(word_fill(leadparam::pindef, 1));
+        REQUIRE(ludwiglib_get_text() == "one two\n  abcdefghijklmnop\nthree\n");
+        REQUIRE(line_nr(current_frame->dot) == 2);
+        REQUIRE(current_frame->dot->col == 3);
+    });
+}
+
+TEST_CASE("justify and squeeze rewrite each line", "[word]") {
+    in_new_session([]() {
+        set_up("a b c\nlast\n", 1, 9, 1);
+        line_ptr line = current_frame->dot->line;
+        mark_ptr c = nullptr;
+        REQUIRE(mark_create(line, 5, c));
+        REQUIRE(word_justify(leadparam::none, 1));
+        REQUIRE(ludwiglib_get_text() == "a     b c\nlast\n");
+        REQUIRE(c->col == 9);
+        REQUIRE(mark_create(line, 1, current_frame->dot));
+        REQUIRE(word_squeeze(leadparam::none, 1));
+        REQUIRE(ludwiglib_get_text() == "a b c\nlast\n");
+        REQUIRE(c->col == 5);
+        REQUIRE(mark_destroy(c));
+    });
+}
+
+TEST_CASE("advance word stays within the paragraph", "[word]") {
+    in_new_session([]() {
+        set_up("one, two\n  three four\n\nfive\n", 1, 79, 1);
+        REQUIRE(newword_advance_word(leadparam::pint, 3));
+        REQUIRE(line_nr(current_frame->dot) == 2);
+        REQUIRE(current_frame->dot->col == 9);
+        REQUIRE(newword_advance_word(leadparam::nint, -2));
+        REQUIRE(line_nr(current_frame->dot) == 1);
+        REQUIRE(current_frame->dot->col == 6);
+        REQUIRE_FALSE(newword_advance_word(leadparam::pint, 4));
+        REQUIRE(line_nr(current_frame->dot) == 1);
+        REQUIRE(current_frame->dot->col == 6);
+    });
+}
+
+TEST_CASE("advance paragraph skips blank lines and indentation", "[word]") {
+    in_new_session([]() {
+        set_up("one\ntwo\n\n\n   three\n", 1, 79, 2);
+        REQUIRE(newword_advance_paragraph(leadparam::pint, 1));
+        REQUIRE(line_nr(current_frame->dot) == 5);
+        REQUIRE(current_frame->dot->col == 4);
+        REQUIRE(newword_advance_paragraph(leadparam::nint, -1));
+        REQUIRE(line_nr(current_frame->dot) == 1);
+        REQUIRE(current_frame->dot->col == 1);
+    });
+}